@@ -18,7 +18,6 @@
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
-#include <QtCore/QStandardPaths>
 #include <QtCore/QTimer>
 #include <QtGui/QImage>
 #include <QtGui/QPixmap>
@@ -65,89 +64,14 @@ private:
             }
         }
 
-        // Build image-data structure for Linux if image is loaded
-        if (!m_loadedImage.isNull()) {
-            QVariantMap imageDataStruct = buildImageDataStructure(m_loadedImage);
-#ifdef Q_OS_LINUX
-            if (!imageDataStruct.isEmpty()) {
-                params["image-data"] = imageDataStruct;
-            }
-#endif
-
-            QString tempPath = saveImageToTempFile(m_loadedImage);
-#ifdef Q_OS_WINDOWS
-            params["appLogoOverride"] = tempPath;
-#endif
-#ifdef Q_OS_ANDROID
-            params["smallIconPath"] = tempPath;
-#endif
-#ifdef Q_OS_IOS
-            params["image"] = tempPath;
-#endif
-
-#ifdef Q_OS_ANDROID
-            if (!imageDataStruct.isEmpty()) {
-                QVariantMap iconDataMap;
-                iconDataMap["data"] = imageDataStruct["data"];
-                iconDataMap["width"] = imageDataStruct["width"];
-                iconDataMap["height"] = imageDataStruct["height"];
-                iconDataMap["channels"] = imageDataStruct["channels"];
-                params["largeIconData"] = iconDataMap;
-            }
-#endif
-        }
+        // Attach the loaded image; engines that need a file path get one from
+        // the library's icon cache
+        if (!m_loadedImage.isNull())
+            params["image"] = m_loadedImage;
 
         return params;
     }
 
-    QVariantMap buildImageDataStructure(const QImage &image) const
-    {
-        if (image.isNull())
-            return QVariantMap();
-
-        // Convert to RGB or RGBA format
-        QImage convertedImage = image;
-        bool hasAlpha = image.hasAlphaChannel();
-
-        if (hasAlpha) {
-            convertedImage = image.convertToFormat(QImage::Format_RGBA8888);
-        } else {
-            convertedImage = image.convertToFormat(QImage::Format_RGB888);
-        }
-
-        int width = convertedImage.width();
-        int height = convertedImage.height();
-        int rowstride = convertedImage.bytesPerLine();
-        int channels = hasAlpha ? 4 : 3;
-        int bitsPerSample = 8;
-
-        // Get image data in RGB/RGBA byte order
-        QByteArray imageData;
-        const uchar *bits = convertedImage.constBits();
-        int dataSize = convertedImage.sizeInBytes();
-        imageData = QByteArray(reinterpret_cast<const char*>(bits), dataSize);
-
-        // Build the DBus structure (iiibiiay)
-        QVariantMap imageDataStruct;
-        imageDataStruct["width"] = width;
-        imageDataStruct["height"] = height;
-        imageDataStruct["rowstride"] = rowstride;
-        imageDataStruct["has_alpha"] = hasAlpha;
-        imageDataStruct["bits_per_sample"] = bitsPerSample;
-        imageDataStruct["channels"] = channels;
-        imageDataStruct["data"] = imageData;
-
-        return imageDataStruct;
-    }
-
-    QString saveImageToTempFile(const QImage &image) const
-    {
-        QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation)
-                           + "/notification_icon.png";
-        image.save(tempPath);
-        return tempPath;
-    }
-
     void loadImageFromResource()
     {
         QString imagePath = ":/images/test.png";
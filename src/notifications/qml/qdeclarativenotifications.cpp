@@ -1,4 +1,6 @@
 #include "qdeclarativenotifications_p.h"
+#include <QtCore/QMetaProperty>
+#include <QtQml/QJSValueIterator>
 
 QT_BEGIN_NAMESPACE
 
@@ -56,7 +58,10 @@ QT_BEGIN_NAMESPACE
     }
     \endqml
 
-    \sa QNotifications
+    To list the notifications that are shown, for instance in an in-app
+    notification center, use a NotificationsModel.
+
+    \sa QNotifications, NotificationsModel
 */
 
 /*!
@@ -121,20 +126,72 @@ bool QDeclarativeNotifications::isSupported() const
     return m_notifications.isSupported();
 }
 
+/*!
+    \qmlmethod object Notifications::statistics()
+
+    Returns a snapshot of the counters of the notification engine, as an object
+    with the properties of QNotificationsStatistics: \c engineName, \c sentCount,
+    \c failedCount, \c updatedCount, \c closedCount, \c droppedSignalCount,
+    \c inFlightCount, \c bytesMarshalled and \c latencyHistogram. The bounds of
+    the histogram's buckets, in microseconds, are in \c latencyBucketBounds.
+
+    \qml
+    Timer {
+        interval: 60000
+        repeat: true
+        running: true
+        onTriggered: {
+            const statistics = notifications.statistics();
+            console.log(statistics.sentCount, "sent,", statistics.failedCount, "failed");
+        }
+    }
+    \endqml
+
+    \sa QNotifications::statistics()
+*/
+QVariantMap QDeclarativeNotifications::statistics() const
+{
+    const QNotificationsStatistics statistics = m_notifications.statistics();
+    QVariantMap map;
+    const QMetaObject &metaObject = QNotificationsStatistics::staticMetaObject;
+    for (int i = metaObject.propertyOffset(); i < metaObject.propertyCount(); ++i) {
+        const QMetaProperty property = metaObject.property(i);
+        map.insert(QString::fromLatin1(property.name()), property.readOnGadget(&statistics));
+    }
+    map.insert(QStringLiteral("latencyBucketBounds"), QVariant::fromValue(QNotificationsStatistics::latencyBucketBounds()));
+    return map;
+}
+
 /*!
     \qmlmethod uint Notifications::sendNotification(string title, string message, var parameters, var actions)
 
     Sends a notification with the given \a title, \a message, \a parameters, and \a actions.
 
+    The properties of \a parameters are described in \l{Qt Notifications Engines}.
+    The actions are added in the order of the properties of \a actions.
+
     Returns the ID of the notification that was sent.
 */
-uint QDeclarativeNotifications::sendNotification(const QString &title, const QString &message, const QVariantMap &parameters, const QVariantMap &actions)
+uint QDeclarativeNotifications::sendNotification(const QString &title, const QString &message, const QJSValue &parameters, const QJSValue &actions)
 {
-    QMap<QString, QString> stringMap;
-    for (auto it = actions.constBegin(); it != actions.constEnd(); ++it) {
-        stringMap.insert(it.key(), it.value().toString());
+    // The JavaScript objects are read straight into the request, without
+    // converting them into maps first
+    QNotificationRequest request(title, message);
+    if (parameters.isObject()) {
+        QJSValueIterator it(parameters);
+        while (it.hasNext()) {
+            it.next();
+            request.setParameter(it.name(), it.value().toVariant());
+        }
+    }
+    if (actions.isObject()) {
+        QJSValueIterator it(actions);
+        while (it.hasNext()) {
+            it.next();
+            request.addAction(it.name(), it.value().toString());
+        }
     }
-    return m_notifications.sendNotification(title, message, parameters, stringMap);
+    return m_notifications.sendNotification(request);
 }
 
 QT_END_NAMESPACE
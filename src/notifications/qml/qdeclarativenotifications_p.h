@@ -2,8 +2,8 @@
 #define QDECLARATIVENOTIFICATIONS_P_H
 
 #include <QtCore/QObject>
-#include <QtCore/QMap>
 #include <QtCore/QString>
+#include <QtQml/QJSValue>
 #include <QtQml/qqml.h>
 #include <qnotifications.h>
 
@@ -16,11 +16,14 @@ class QDeclarativeNotifications : public QObject
 public:
     explicit QDeclarativeNotifications(QObject *parent = nullptr);
 
+    QNotifications *notifications() { return &m_notifications; }
+
     Q_INVOKABLE bool isSupported() const;
+    Q_INVOKABLE QVariantMap statistics() const;
     Q_INVOKABLE uint sendNotification(const QString &title,
                                       const QString &message,
-                                      const QVariantMap &parameters = {},
-                                      const QVariantMap &actions = {});
+                                      const QJSValue &parameters = QJSValue(),
+                                      const QJSValue &actions = QJSValue());
 
 signals:
     void actionInvoked(uint notificationId, const QString &actionKey);
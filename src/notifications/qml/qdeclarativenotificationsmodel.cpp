@@ -0,0 +1,371 @@
+#include "qdeclarativenotificationsmodel_p.h"
+
+#include <algorithm>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \qmltype NotificationsModel
+    \inqmlmodule QtNotifications
+    \brief Provides the notifications sent by a Notifications object as a model.
+
+    NotificationsModel lists the notifications sent through a \l Notifications
+    object while they are shown, in the order they were sent. It is meant for
+    views such as an in-app notification center, and changes row by row: a new
+    notification inserts a row, an update or a click changes the roles of its
+    row, and closing a notification removes its row, or marks it as closed if
+    \l keepClosed is set. The model is never reset except by clear() and by
+    changing \l notifications, so views keep their scroll position and
+    delegates while notifications come and go.
+
+    \qml
+    Notifications {
+        id: notifications
+    }
+
+    ListView {
+        model: NotificationsModel {
+            notifications: notifications
+        }
+        delegate: Text {
+            text: model.title + ": " + model.message
+        }
+    }
+    \endqml
+
+    The model provides the following roles:
+
+    \table
+        \header
+            \li Role
+            \li Type
+            \li Description
+        \row
+            \li \c notificationId
+            \li uint
+            \li The ID of the notification. If the platform shows an update
+                under a new ID, the row of the updated notification takes it.
+        \row
+            \li \c title
+            \li string
+            \li The title of the notification
+        \row
+            \li \c message
+            \li string
+            \li The body text of the notification
+        \row
+            \li \c category
+            \li string
+            \li The category of the notification
+        \row
+            \li \c group
+            \li string
+            \li The group of the notification
+        \row
+            \li \c urgency
+            \li int
+            \li The urgency of the notification: 0=Low, 1=Normal, 2=Critical
+        \row
+            \li \c state
+            \li enumeration
+            \li \c NotificationsModel.Shown, \c NotificationsModel.Clicked or
+                \c NotificationsModel.Closed
+        \row
+            \li \c closedReason
+            \li enumeration
+            \li Why the notification was closed, see Notifications::ClosedReason
+        \row
+            \li \c invokedAction
+            \li string
+            \li The key of the action the user invoked last, if any
+        \row
+            \li \c postedAt
+            \li date
+            \li When the platform accepted the notification
+        \row
+            \li \c updatedAt
+            \li date
+            \li When the notification was last updated, or sent
+        \row
+            \li \c closedAt
+            \li date
+            \li When the notification was closed
+    \endtable
+
+    Only notifications whose IDs reach the Notifications object after the model
+    is attached to it are listed; see QNotifications::notificationPosted().
+*/
+
+/*!
+    \qmlproperty Notifications NotificationsModel::notifications
+
+    This property holds the Notifications object whose notifications are listed.
+    Changing it clears the model.
+*/
+
+/*!
+    \qmlproperty bool NotificationsModel::keepClosed
+
+    This property holds whether closed notifications stay in the model.
+
+    If \c false, the default, the row of a notification is removed when it is
+    closed. If \c true, the row stays with its \c state set to
+    \c NotificationsModel.Closed, until removeClosed() or clear() is called.
+*/
+
+/*!
+    \qmlproperty int NotificationsModel::count
+
+    This property holds the number of rows in the model.
+*/
+
+QDeclarativeNotificationsModel::QDeclarativeNotificationsModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+QDeclarativeNotifications *QDeclarativeNotificationsModel::notifications() const
+{
+    return m_notifications;
+}
+
+void QDeclarativeNotificationsModel::setNotifications(QDeclarativeNotifications *notifications)
+{
+    if (m_notifications == notifications)
+        return;
+    for (const QMetaObject::Connection &connection : std::as_const(m_connections))
+        disconnect(connection);
+    m_connections.clear();
+
+    m_notifications = notifications;
+    clear();
+    if (notifications) {
+        QNotifications *source = notifications->notifications();
+        m_connections = {
+            connect(source, &QNotifications::notificationPosted, this, &QDeclarativeNotificationsModel::onNotificationPosted),
+            connect(source, &QNotifications::notificationClicked, this, &QDeclarativeNotificationsModel::onNotificationClicked),
+            connect(source, &QNotifications::actionInvoked, this, &QDeclarativeNotificationsModel::onActionInvoked),
+            connect(source, &QNotifications::notificationClosed, this, &QDeclarativeNotificationsModel::onNotificationClosed)
+        };
+    }
+    emit notificationsChanged();
+}
+
+bool QDeclarativeNotificationsModel::keepClosed() const
+{
+    return m_keepClosed;
+}
+
+void QDeclarativeNotificationsModel::setKeepClosed(bool keep)
+{
+    if (m_keepClosed == keep)
+        return;
+    m_keepClosed = keep;
+    if (!keep)
+        removeClosed();
+    emit keepClosedChanged();
+}
+
+int QDeclarativeNotificationsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_entries.size());
+}
+
+QVariant QDeclarativeNotificationsModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return QVariant();
+    const Entry &entry = m_entries.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return entry.request.title();
+    case NotificationIdRole:
+        return entry.notificationId;
+    case MessageRole:
+        return entry.request.message();
+    case CategoryRole:
+        return entry.request.category();
+    case GroupRole:
+        return entry.request.group();
+    case UrgencyRole:
+        return int(entry.request.urgency());
+    case StateRole:
+        return entry.state;
+    case ClosedReasonRole:
+        return entry.closedReason;
+    case InvokedActionRole:
+        return entry.invokedAction;
+    case PostedAtRole:
+        return entry.postedAt;
+    case UpdatedAtRole:
+        return entry.updatedAt;
+    case ClosedAtRole:
+        return entry.closedAt;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> QDeclarativeNotificationsModel::roleNames() const
+{
+    return {
+        { NotificationIdRole, QByteArrayLiteral("notificationId") },
+        { TitleRole, QByteArrayLiteral("title") },
+        { MessageRole, QByteArrayLiteral("message") },
+        { CategoryRole, QByteArrayLiteral("category") },
+        { GroupRole, QByteArrayLiteral("group") },
+        { UrgencyRole, QByteArrayLiteral("urgency") },
+        { StateRole, QByteArrayLiteral("state") },
+        { ClosedReasonRole, QByteArrayLiteral("closedReason") },
+        { InvokedActionRole, QByteArrayLiteral("invokedAction") },
+        { PostedAtRole, QByteArrayLiteral("postedAt") },
+        { UpdatedAtRole, QByteArrayLiteral("updatedAt") },
+        { ClosedAtRole, QByteArrayLiteral("closedAt") }
+    };
+}
+
+/*!
+    \qmlmethod void NotificationsModel::removeClosed()
+
+    Removes the rows of all closed notifications.
+
+    \sa keepClosed
+*/
+void QDeclarativeNotificationsModel::removeClosed()
+{
+    // Each run of closed rows is removed at once, from the end so that the
+    // rows in front keep their numbers
+    qsizetype last = m_entries.size() - 1;
+    while (last >= 0) {
+        if (m_entries.at(last).state != Closed) {
+            --last;
+            continue;
+        }
+        qsizetype first = last;
+        while (first > 0 && m_entries.at(first - 1).state == Closed)
+            --first;
+        beginRemoveRows(QModelIndex(), int(first), int(last));
+        m_entries.remove(first, last - first + 1);
+        endRemoveRows();
+        emit countChanged();
+        last = first - 1;
+    }
+}
+
+/*!
+    \qmlmethod void NotificationsModel::clear()
+
+    Removes all rows. Notifications that are still shown are listed again if
+    they are updated.
+*/
+void QDeclarativeNotificationsModel::clear()
+{
+    if (m_entries.isEmpty())
+        return;
+    beginResetModel();
+    m_entries.clear();
+    m_serials.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+// Rows are appended in the order of their serials, so the row of a
+// notification is found by binary search rather than by scanning the model
+qsizetype QDeclarativeNotificationsModel::rowOf(uint notificationId) const
+{
+    const auto serial = m_serials.constFind(notificationId);
+    if (serial == m_serials.cend())
+        return -1;
+    const auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), *serial,
+                                     [](const Entry &entry, quint64 value) { return entry.serial < value; });
+    return it != m_entries.cend() && it->serial == *serial ? it - m_entries.cbegin() : -1;
+}
+
+void QDeclarativeNotificationsModel::onNotificationPosted(uint notificationId, const QNotificationRequest &request,
+                                                          uint replacedId)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    QList<int> roles = { Qt::DisplayRole, TitleRole, MessageRole, CategoryRole, GroupRole, UrgencyRole,
+                         UpdatedAtRole };
+    qsizetype row = rowOf(notificationId);
+    if (row < 0 && replacedId != 0 && replacedId != notificationId) {
+        // The platform showed the update under a new ID; the row follows it
+        row = rowOf(replacedId);
+        if (row >= 0) {
+            m_serials.insert(notificationId, m_serials.take(replacedId));
+            m_entries[row].notificationId = notificationId;
+            roles.append(NotificationIdRole);
+        }
+    }
+    if (row >= 0) {
+        Entry &entry = m_entries[row];
+        entry.request = request;
+        entry.updatedAt = now;
+        const QModelIndex index = this->index(int(row));
+        emit dataChanged(index, index, roles);
+        return;
+    }
+
+    Entry entry;
+    entry.serial = m_nextSerial++;
+    entry.notificationId = notificationId;
+    entry.request = request;
+    entry.postedAt = now;
+    entry.updatedAt = now;
+    const int row = int(m_entries.size());
+    beginInsertRows(QModelIndex(), row, row);
+    m_serials.insert(notificationId, entry.serial);
+    m_entries.append(std::move(entry));
+    endInsertRows();
+    emit countChanged();
+}
+
+void QDeclarativeNotificationsModel::onNotificationClicked(uint notificationId)
+{
+    const qsizetype row = rowOf(notificationId);
+    if (row < 0)
+        return;
+    m_entries[row].state = Clicked;
+    const QModelIndex index = this->index(int(row));
+    emit dataChanged(index, index, { StateRole });
+}
+
+void QDeclarativeNotificationsModel::onActionInvoked(uint notificationId, const QString &actionKey)
+{
+    const qsizetype row = rowOf(notificationId);
+    if (row < 0)
+        return;
+    m_entries[row].invokedAction = actionKey;
+    const QModelIndex index = this->index(int(row));
+    emit dataChanged(index, index, { InvokedActionRole });
+}
+
+void QDeclarativeNotificationsModel::onNotificationClosed(uint notificationId, QNotifications::ClosedReason reason)
+{
+    const qsizetype row = rowOf(notificationId);
+    if (row < 0)
+        return;
+    // The platform may hand out the ID again, for a new notification
+    m_serials.remove(notificationId);
+    if (!m_keepClosed) {
+        removeEntry(row);
+        return;
+    }
+    Entry &entry = m_entries[row];
+    entry.state = Closed;
+    entry.closedReason = reason;
+    entry.closedAt = QDateTime::currentDateTime();
+    const QModelIndex index = this->index(int(row));
+    emit dataChanged(index, index, { StateRole, ClosedReasonRole, ClosedAtRole });
+}
+
+void QDeclarativeNotificationsModel::removeEntry(qsizetype row)
+{
+    beginRemoveRows(QModelIndex(), int(row), int(row));
+    m_entries.remove(row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+QT_END_NAMESPACE
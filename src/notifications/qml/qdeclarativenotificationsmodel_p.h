@@ -0,0 +1,100 @@
+#ifndef QDECLARATIVENOTIFICATIONSMODEL_P_H
+#define QDECLARATIVENOTIFICATIONSMODEL_P_H
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPointer>
+#include <QtQml/qqml.h>
+#include <qnotifications.h>
+#include "qdeclarativenotifications_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QDeclarativeNotificationsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_NAMED_ELEMENT(NotificationsModel)
+    Q_PROPERTY(QDeclarativeNotifications *notifications READ notifications WRITE setNotifications NOTIFY notificationsChanged)
+    Q_PROPERTY(bool keepClosed READ keepClosed WRITE setKeepClosed NOTIFY keepClosedChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum State {
+        Shown,
+        Clicked,
+        Closed
+    };
+    Q_ENUM(State)
+
+    enum Role {
+        NotificationIdRole = Qt::UserRole + 1,
+        TitleRole,
+        MessageRole,
+        CategoryRole,
+        GroupRole,
+        UrgencyRole,
+        StateRole,
+        ClosedReasonRole,
+        InvokedActionRole,
+        PostedAtRole,
+        UpdatedAtRole,
+        ClosedAtRole
+    };
+    Q_ENUM(Role)
+
+    explicit QDeclarativeNotificationsModel(QObject *parent = nullptr);
+
+    QDeclarativeNotifications *notifications() const;
+    void setNotifications(QDeclarativeNotifications *notifications);
+
+    bool keepClosed() const;
+    void setKeepClosed(bool keep);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    Q_INVOKABLE void removeClosed();
+    Q_INVOKABLE void clear();
+
+signals:
+    void notificationsChanged();
+    void keepClosedChanged();
+    void countChanged();
+
+private:
+    struct Entry
+    {
+        // Increases with every row appended, so that rows are sorted by it
+        quint64 serial = 0;
+        uint notificationId = 0;
+        QNotificationRequest request;
+        State state = Shown;
+        QNotifications::ClosedReason closedReason = QNotifications::Undefined;
+        QString invokedAction;
+        QDateTime postedAt;
+        QDateTime updatedAt;
+        QDateTime closedAt;
+    };
+
+    qsizetype rowOf(uint notificationId) const;
+    void onNotificationPosted(uint notificationId, const QNotificationRequest &request, uint replacedId);
+    void onNotificationClicked(uint notificationId);
+    void onActionInvoked(uint notificationId, const QString &actionKey);
+    void onNotificationClosed(uint notificationId, QNotifications::ClosedReason reason);
+    void removeEntry(qsizetype row);
+
+    QPointer<QDeclarativeNotifications> m_notifications;
+    QList<QMetaObject::Connection> m_connections;
+    QList<Entry> m_entries;
+    // Serial of the row of every notification in the model
+    QHash<uint, quint64> m_serials;
+    quint64 m_nextSerial = 0;
+    bool m_keepClosed = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QDECLARATIVENOTIFICATIONSMODEL_P_H
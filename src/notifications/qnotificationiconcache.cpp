@@ -0,0 +1,217 @@
+#include "qnotificationiconcache_p.h"
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+
+#if defined(Q_OS_UNIX)
+#  include <unistd.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+// Both locations belong to the user, unlike the temporary directory, where
+// another user could create the cache directory first and plant images in it
+static QString defaultIconCacheDirectory()
+{
+    const QString runtimeDirectory = qEnvironmentVariable("XDG_RUNTIME_DIR");
+    if (!runtimeDirectory.isEmpty())
+        return runtimeDirectory + QStringLiteral("/qtnotifications-icons");
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/qtnotifications-icons");
+}
+
+// Whether the directory belongs to this user and no other user can list it
+// or write to it
+static bool isPrivateDirectory(const QString &path)
+{
+#if defined(Q_OS_UNIX)
+    const QFileInfo info(path);
+    const QFileDevice::Permissions othersAccess = QFileDevice::ReadGroup | QFileDevice::WriteGroup
+            | QFileDevice::ExeGroup | QFileDevice::ReadOther | QFileDevice::WriteOther
+            | QFileDevice::ExeOther;
+    return info.isDir() && info.ownerId() == uint(::geteuid()) && !(info.permissions() & othersAccess);
+#else
+    return QFileInfo(path).isDir();
+#endif
+}
+
+Q_GLOBAL_STATIC(QNotificationIconCache, notificationIconCache)
+
+/*
+    Returns the icon cache shared by all engines of the process.
+
+    Engines that can only reference images by file path use the cache to turn
+    a QImage into a file: each distinct image is encoded once and then reused,
+    by this process and by later runs, until it is evicted as least recently used.
+*/
+QNotificationIconCache *QNotificationIconCache::instance()
+{
+    return notificationIconCache();
+}
+
+QNotificationIconCache::QNotificationIconCache()
+    : QNotificationIconCache(defaultIconCacheDirectory())
+{
+}
+
+QNotificationIconCache::QNotificationIconCache(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+QString QNotificationIconCache::directory() const
+{
+    return m_directory;
+}
+
+void QNotificationIconCache::setMaximumEntries(qsizetype entries)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maximumEntries = qMax<qsizetype>(1, entries);
+    if (m_indexLoaded)
+        evict();
+}
+
+qsizetype QNotificationIconCache::maximumEntries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumEntries;
+}
+
+/*
+    Returns the path of a PNG file showing \a image, writing it first if the
+    cache does not hold it yet. Returns an empty string if the file could not
+    be written.
+*/
+QString QNotificationIconCache::pathForImage(const QImage &image)
+{
+    if (image.isNull())
+        return QString();
+
+    QMutexLocker locker(&m_mutex);
+    loadIndex();
+    if (!m_directoryTrusted)
+        return QString();
+
+    // Hashing is only needed the first time this process sees an image;
+    // copies of a QImage share its cache key
+    QString digest = m_digestsByCacheKey.value(image.cacheKey());
+    if (digest.isEmpty()) {
+        digest = digestOf(image);
+        if (m_digestsByCacheKey.size() >= 4 * m_maximumEntries)
+            m_digestsByCacheKey.clear();
+        m_digestsByCacheKey.insert(image.cacheKey(), digest);
+    }
+
+    const QString path = filePath(digest);
+    if (m_entries.contains(digest)) {
+        // The file may have been evicted by another process sharing the cache,
+        // or removed by a cleaner of temporary files; it is written again then
+        if (QFileInfo::exists(path)) {
+            touch(digest);
+            return path;
+        }
+        m_entries.remove(digest);
+        m_lru.removeOne(digest);
+        m_touched.remove(digest);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG") || !file.commit()) {
+        qWarning("QtNotifications: Could not write icon cache entry %s", qPrintable(path));
+        return QString();
+    }
+    m_entries.insert(digest);
+    m_lru.append(digest);
+    m_touched.insert(digest);
+    evict();
+    return path;
+}
+
+QString QNotificationIconCache::digestOf(const QImage &image)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    const int header[] = { int(image.format()), image.width(), image.height() };
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(header), sizeof(header)));
+
+    // Hash scan lines without their padding, which is not guaranteed to be initialized
+    const qsizetype lineLength = (qsizetype(image.width()) * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y)
+        hash.addData(QByteArrayView(reinterpret_cast<const char *>(image.constScanLine(y)), lineLength));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+void QNotificationIconCache::loadIndex()
+{
+    if (m_indexLoaded)
+        return;
+    m_indexLoaded = true;
+
+    QDir dir(m_directory);
+    if (!dir.exists()) {
+        // Created private from the start, not made private after the fact;
+        // another process of the user may have created it meanwhile
+        const QString parent = QFileInfo(m_directory).absolutePath();
+        const bool created = QDir().mkpath(parent)
+                && QDir().mkdir(m_directory, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+        if (!created && !QFileInfo(m_directory).isDir()) {
+            qWarning("QtNotifications: Could not create icon cache directory %s", qPrintable(m_directory));
+            return;
+        }
+    }
+    // Images found in a directory that others can write to could be anything
+    if (!isPrivateDirectory(m_directory)) {
+        qWarning("QtNotifications: Not using icon cache directory %s, which is not private to the user",
+                 qPrintable(m_directory));
+        return;
+    }
+    m_directoryTrusted = true;
+
+    // Entries written by earlier runs keep their order through the file times
+    const QFileInfoList files = dir.entryInfoList({ QStringLiteral("*.png") }, QDir::Files,
+                                                  QDir::Time | QDir::Reversed);
+    for (const QFileInfo &info : files) {
+        const QString digest = info.completeBaseName();
+        m_entries.insert(digest);
+        m_lru.append(digest);
+    }
+    evict();
+}
+
+void QNotificationIconCache::touch(const QString &digest)
+{
+    if (m_lru.constLast() != digest) {
+        m_lru.removeOne(digest);
+        m_lru.append(digest);
+    }
+
+    // The file time only matters for the order seen by the next run,
+    // so it is refreshed once per process
+    if (m_touched.contains(digest))
+        return;
+    m_touched.insert(digest);
+    QFile file(filePath(digest));
+    if (file.open(QIODevice::Append))
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+void QNotificationIconCache::evict()
+{
+    while (m_lru.size() > m_maximumEntries) {
+        const QString digest = m_lru.takeFirst();
+        m_entries.remove(digest);
+        m_touched.remove(digest);
+        QFile::remove(filePath(digest));
+    }
+}
+
+QString QNotificationIconCache::filePath(const QString &digest) const
+{
+    return m_directory + QLatin1Char('/') + digest + QStringLiteral(".png");
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,63 @@
+#ifndef QNOTIFICATIONICONCACHE_P_H
+#define QNOTIFICATIONICONCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNotifications/qnotifications_global.h>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtGui/QImage>
+
+QT_BEGIN_NAMESPACE
+
+class Q_NOTIFICATIONS_EXPORT QNotificationIconCache
+{
+public:
+    static QNotificationIconCache *instance();
+
+    QNotificationIconCache();
+    explicit QNotificationIconCache(const QString &directory);
+
+    QString directory() const;
+    QString pathForImage(const QImage &image);
+
+    void setMaximumEntries(qsizetype entries);
+    qsizetype maximumEntries() const;
+
+private:
+    static QString digestOf(const QImage &image);
+    void loadIndex();
+    void touch(const QString &digest);
+    void evict();
+    QString filePath(const QString &digest) const;
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    bool m_indexLoaded = false;
+    // Whether the directory is private to the user; the cache is unused if not
+    bool m_directoryTrusted = false;
+    // Digests of the cached files, least recently used first
+    QList<QString> m_lru;
+    QSet<QString> m_entries;
+    // Digests already touched by this process, whose file times are current
+    QSet<QString> m_touched;
+    // Digests of images seen by this process, to skip hashing shared images
+    QHash<qint64, QString> m_digestsByCacheKey;
+    qsizetype m_maximumEntries = 256;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONICONCACHE_P_H
@@ -0,0 +1,341 @@
+#include "qnotificationjournal_p.h"
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#if defined(Q_OS_UNIX)
+#  include <sys/mman.h>
+#elif defined(Q_OS_WIN)
+#  include <QtCore/qt_windows.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// The journal is a header followed by fixed-size records, in the byte order of
+// the machine that wrote them. The count is written after the record it
+// accounts for, so a torn append is simply not seen by the next replay. The
+// header names the notification server that assigned the recorded IDs
+struct JournalHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 recordSize;
+    quint64 count;
+    quint32 serverIdentityLength;
+    quint32 reserved;
+    char serverIdentity[96];
+};
+
+struct JournalRecord
+{
+    quint32 notificationId;
+    quint8 outcome;
+    quint8 categoryLength;
+    quint8 reserved[2];
+    qint64 timestamp;
+    char category[48];
+};
+
+static_assert(sizeof(JournalHeader) == 128);
+static_assert(sizeof(JournalRecord) == 64);
+
+constexpr char JournalMagic[8] = { 'Q', 'N', 'J', 'O', 'U', 'R', 'N', 'L' };
+constexpr quint32 JournalVersion = 2;
+constexpr qint64 InitialCapacity = 1024;
+// Mapped pages are written back at most this often, and when the journal is closed
+constexpr int SyncInterval = 1000;
+
+JournalRecord journalRecord(uint notificationId, quint8 outcome, qint64 timestamp,
+                                   const QString &category)
+{
+    JournalRecord record = {};
+    record.notificationId = notificationId;
+    record.outcome = outcome;
+    record.timestamp = timestamp;
+    if (!category.isEmpty()) {
+        QByteArray utf8 = category.toUtf8();
+        if (utf8.size() > qsizetype(sizeof(record.category))) {
+            // Do not cut a multi-byte character in half
+            qsizetype length = sizeof(record.category);
+            while (length > 0 && (uchar(utf8.at(length)) & 0xc0) == 0x80)
+                --length;
+            utf8.truncate(length);
+        }
+        record.categoryLength = quint8(utf8.size());
+        std::memcpy(record.category, utf8.constData(), utf8.size());
+    }
+    return record;
+}
+
+// The server identity as stored in the header, cut to the space it has there
+QByteArray journalServerIdentity(const QString &serverIdentity)
+{
+    return serverIdentity.toUtf8().left(sizeof(JournalHeader::serverIdentity));
+}
+
+void writeServerIdentity(JournalHeader &header, const QByteArray &serverIdentity)
+{
+    std::memset(header.serverIdentity, 0, sizeof(header.serverIdentity));
+    std::memcpy(header.serverIdentity, serverIdentity.constData(), serverIdentity.size());
+    header.serverIdentityLength = quint32(serverIdentity.size());
+}
+
+} // namespace
+
+QNotificationJournal::QNotificationJournal(const QString &path)
+    : m_path(path)
+{
+}
+
+QNotificationJournal::~QNotificationJournal()
+{
+    QMutexLocker locker(&m_mutex);
+    unmap();
+    m_file.close();
+}
+
+/*
+    Returns the journal used when none is named: a file in the application's
+    local data directory, so that every application has its own.
+*/
+QString QNotificationJournal::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+            + QStringLiteral("/notifications.journal");
+}
+
+QString QNotificationJournal::path() const
+{
+    return m_path;
+}
+
+/*
+    Replays the journal left by earlier runs, rewrites it with only the
+    notifications that are still outstanding, and maps it for appending.
+    Notifications recorded for a server other than \a serverIdentity are
+    dropped, as their IDs may by now belong to other applications.
+
+    Only one journal object can have a file open at a time, in this or any other
+    process. Returns false if the journal is open elsewhere or could not be
+    written.
+*/
+bool QNotificationJournal::open(const QString &serverIdentity)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_data)
+        return true;
+
+    const QString directory = QFileInfo(m_path).absolutePath();
+    if (!QDir().mkpath(directory)) {
+        qWarning("QtNotifications: Could not create journal directory %s", qPrintable(directory));
+        return false;
+    }
+
+    // Two writers would each append at their own count and overwrite each
+    // other's records. A lock left by a process that died is taken over
+    m_lock = std::make_unique<QLockFile>(m_path + QStringLiteral(".lock"));
+    if (!m_lock->tryLock(0)) {
+        qWarning("QtNotifications: Journal %s is already open", qPrintable(m_path));
+        m_lock.reset();
+        return false;
+    }
+
+    m_serverIdentity = journalServerIdentity(serverIdentity);
+    m_outstanding = replay();
+    if (!create(m_outstanding)) {
+        qWarning("QtNotifications: Could not write journal %s", qPrintable(m_path));
+        m_outstanding.clear();
+        m_lock.reset();
+        return false;
+    }
+    return true;
+}
+
+/*
+    Forgets every recorded notification, because the server that assigned
+    their IDs is gone, and records that new IDs come from \a serverIdentity.
+*/
+void QNotificationJournal::reset(const QString &serverIdentity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_outstanding.clear();
+    m_serverIdentity = journalServerIdentity(serverIdentity);
+    if (!m_data)
+        return;
+
+    JournalHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    header.count = 0;
+    writeServerIdentity(header, m_serverIdentity);
+    std::memcpy(m_data, &header, sizeof(header));
+    m_count = 0;
+    sync();
+}
+
+QList<QNotificationJournal::Entry> QNotificationJournal::outstandingEntries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_outstanding;
+}
+
+QList<QNotificationJournal::Entry> QNotificationJournal::replay()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(JournalHeader)))
+        return {};
+    const uchar *data = file.map(0, file.size());
+    if (!data)
+        return {};
+
+    JournalHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, JournalMagic, sizeof(JournalMagic)) != 0
+            || header.version != JournalVersion || header.recordSize != sizeof(JournalRecord)) {
+        qWarning("QtNotifications: Ignoring incompatible journal %s", qPrintable(m_path));
+        return {};
+    }
+    // A server that was restarted, possibly before a reboot, numbers its
+    // notifications from the start again
+    const QByteArray serverIdentity(header.serverIdentity,
+                                    qMin<qsizetype>(header.serverIdentityLength, sizeof(header.serverIdentity)));
+    if (serverIdentity != m_serverIdentity)
+        return {};
+    const quint64 count = qMin<quint64>(header.count, (file.size() - sizeof(JournalHeader)) / sizeof(JournalRecord));
+
+    // The last record about a notification decides whether it is still shown
+    QHash<uint, Entry> latest;
+    QList<uint> order;
+    const uchar *records = data + sizeof(JournalHeader);
+    for (quint64 i = 0; i < count; ++i) {
+        JournalRecord record;
+        std::memcpy(&record, records + i * sizeof(JournalRecord), sizeof(record));
+        if (record.notificationId == 0)
+            continue;
+        if (record.outcome != Sent) {
+            latest.remove(record.notificationId);
+            continue;
+        }
+        if (!latest.contains(record.notificationId))
+            order.append(record.notificationId);
+        const qsizetype length = qMin<qsizetype>(record.categoryLength, sizeof(record.category));
+        latest.insert(record.notificationId,
+                      { record.notificationId, Sent, record.timestamp,
+                        QString::fromUtf8(record.category, length) });
+    }
+
+    QList<Entry> outstanding;
+    outstanding.reserve(latest.size());
+    for (uint notificationId : std::as_const(order)) {
+        if (auto it = latest.find(notificationId); it != latest.end()) {
+            outstanding.append(*it);
+            latest.erase(it);
+        }
+    }
+    return outstanding;
+}
+
+bool QNotificationJournal::create(const QList<Entry> &entries)
+{
+    const qint64 capacity = qMax(InitialCapacity, qint64(entries.size()) * 2);
+
+    // Compacted into a new file, so that a crash leaves either journal intact
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    JournalHeader header = {};
+    std::memcpy(header.magic, JournalMagic, sizeof(JournalMagic));
+    header.version = JournalVersion;
+    header.recordSize = sizeof(JournalRecord);
+    header.count = entries.size();
+    writeServerIdentity(header, m_serverIdentity);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const Entry &entry : entries) {
+        const JournalRecord record = journalRecord(entry.notificationId, entry.outcome,
+                                                   entry.timestamp, entry.category);
+        file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    if (!file.commit())
+        return false;
+
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::ReadWrite))
+        return false;
+    m_count = entries.size();
+    return map(capacity);
+}
+
+bool QNotificationJournal::map(qint64 capacity)
+{
+    const qint64 size = qint64(sizeof(JournalHeader)) + capacity * qint64(sizeof(JournalRecord));
+    if (m_file.size() < size && !m_file.resize(size))
+        return false;
+    m_data = m_file.map(0, size);
+    if (!m_data)
+        return false;
+    m_capacity = capacity;
+    m_lastSync.start();
+    return true;
+}
+
+void QNotificationJournal::unmap()
+{
+    if (!m_data)
+        return;
+    sync();
+    m_file.unmap(m_data);
+    m_data = nullptr;
+}
+
+/*
+    Records the \a outcome of a notification. This is a copy into the mapped
+    file; the pages are written back to disk by the operating system, and
+    explicitly by the first append a second after the last write-back.
+*/
+void QNotificationJournal::append(uint notificationId, Outcome outcome, const QString &category)
+{
+    const JournalRecord record = journalRecord(notificationId, outcome,
+                                               QDateTime::currentMSecsSinceEpoch(), category);
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_data)
+        return;
+    if (m_count == m_capacity) {
+        unmap();
+        if (!map(m_capacity * 2)) {
+            qWarning("QtNotifications: Could not grow journal %s", qPrintable(m_path));
+            return;
+        }
+    }
+
+    std::memcpy(m_data + sizeof(JournalHeader) + m_count * sizeof(JournalRecord), &record, sizeof(record));
+    const quint64 count = ++m_count;
+    std::memcpy(m_data + offsetof(JournalHeader, count), &count, sizeof(count));
+
+    if (m_lastSync.elapsed() >= SyncInterval)
+        sync();
+}
+
+// Starts writing the mapped pages back to disk; the caller holds the lock
+void QNotificationJournal::sync()
+{
+    if (!m_data)
+        return;
+    const size_t size = sizeof(JournalHeader) + m_capacity * sizeof(JournalRecord);
+#if defined(Q_OS_UNIX)
+    ::msync(m_data, size, MS_ASYNC);
+#elif defined(Q_OS_WIN)
+    ::FlushViewOfFile(m_data, size);
+#endif
+    m_lastSync.restart();
+}
+
+QT_END_NAMESPACE
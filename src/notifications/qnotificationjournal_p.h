@@ -0,0 +1,80 @@
+#ifndef QNOTIFICATIONJOURNAL_P_H
+#define QNOTIFICATIONJOURNAL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNotifications/qnotifications_global.h>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QLockFile>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class Q_NOTIFICATIONS_EXPORT QNotificationJournal
+{
+public:
+    enum Outcome : quint8 {
+        Sent = 1,
+        Failed,
+        Closed
+    };
+
+    struct Entry
+    {
+        uint notificationId = 0;
+        Outcome outcome = Sent;
+        qint64 timestamp = 0;
+        QString category;
+    };
+
+    explicit QNotificationJournal(const QString &path);
+    ~QNotificationJournal();
+
+    static QString defaultPath();
+
+    bool open(const QString &serverIdentity);
+    void reset(const QString &serverIdentity);
+    QString path() const;
+    QList<Entry> outstandingEntries() const;
+
+    void append(uint notificationId, Outcome outcome, const QString &category = QString());
+
+private:
+    QList<Entry> replay();
+    bool create(const QList<Entry> &entries);
+    bool map(qint64 capacity);
+    void unmap();
+    void sync();
+
+    mutable QMutex m_mutex;
+    QString m_path;
+    // Held while the journal is open, so that no other writer maps the file
+    std::unique_ptr<QLockFile> m_lock;
+    QByteArray m_serverIdentity;
+    QFile m_file;
+    uchar *m_data = nullptr;
+    qint64 m_capacity = 0;
+    qint64 m_count = 0;
+    // Outstanding notifications of earlier runs, as found by open()
+    QList<Entry> m_outstanding;
+    QElapsedTimer m_lastSync;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONJOURNAL_P_H
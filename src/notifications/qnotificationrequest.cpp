@@ -0,0 +1,424 @@
+#include "qnotificationrequest.h"
+
+QT_BEGIN_NAMESPACE
+
+class QNotificationRequestPrivate : public QSharedData
+{
+public:
+    QString title;
+    QString message;
+    QString icon;
+    QString category;
+    QString group;
+    QImage image;
+    // Key and label of each action, in insertion order
+    QStringList actions;
+    QVariantMap hints;
+    int expireTimeout = -1;
+    int sendTimeout = -1;
+    QNotificationRequest::Urgency urgency = QNotificationRequest::Normal;
+};
+
+QT_DEFINE_QSDP_SPECIALIZATION_DTOR(QNotificationRequestPrivate)
+
+/*!
+    \class QNotificationRequest
+    \inmodule QtNotifications
+    \brief The QNotificationRequest class describes a notification to be sent.
+
+    QNotificationRequest holds everything a notification engine needs to show a
+    notification: its title and message, the typed properties that all engines
+    understand, its actions, and any engine-specific hints.
+
+    QNotificationRequest is implicitly shared, so it can be passed through
+    QNotifications and the platform engine without copying its contents.
+
+    \code
+    QNotificationRequest request(QStringLiteral("Download finished"),
+                                 QStringLiteral("report.pdf was saved to Downloads"));
+    request.setUrgency(QNotificationRequest::Low);
+    request.addAction(QStringLiteral("open"), QStringLiteral("Open"));
+    notifications.sendNotification(request);
+    \endcode
+
+    \sa QNotifications::sendNotification()
+*/
+
+/*!
+    \enum QNotificationRequest::Urgency
+
+    This enum describes how urgent a notification is.
+
+    \value Low
+        The notification is informational and may be shown unobtrusively.
+    \value Normal
+        The notification is shown the way the platform shows notifications by default.
+    \value Critical
+        The notification needs the user's attention and may not expire.
+*/
+
+/*!
+    Constructs an empty notification request.
+*/
+QNotificationRequest::QNotificationRequest()
+    : d(new QNotificationRequestPrivate)
+{
+}
+
+/*!
+    Constructs a notification request with the given \a title and \a message.
+*/
+QNotificationRequest::QNotificationRequest(const QString &title, const QString &message)
+    : d(new QNotificationRequestPrivate)
+{
+    d->title = title;
+    d->message = message;
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QNotificationRequest::QNotificationRequest(const QNotificationRequest &other) = default;
+
+/*!
+    \fn QNotificationRequest::QNotificationRequest(QNotificationRequest &&other)
+
+    Move-constructs a notification request from \a other.
+*/
+
+/*!
+    Assigns \a other to this notification request.
+*/
+QNotificationRequest &QNotificationRequest::operator=(const QNotificationRequest &other) = default;
+
+/*!
+    \fn QNotificationRequest &QNotificationRequest::operator=(QNotificationRequest &&other)
+
+    Move-assigns \a other to this notification request.
+*/
+
+/*!
+    Destroys the notification request.
+*/
+QNotificationRequest::~QNotificationRequest() = default;
+
+/*!
+    \fn void QNotificationRequest::swap(QNotificationRequest &other)
+
+    Swaps this notification request with \a other.
+*/
+
+/*!
+    Returns the title of the notification.
+
+    \sa setTitle()
+*/
+QString QNotificationRequest::title() const
+{
+    return d->title;
+}
+
+/*!
+    Sets the title of the notification to \a title.
+
+    \sa title()
+*/
+void QNotificationRequest::setTitle(const QString &title)
+{
+    d->title = title;
+}
+
+/*!
+    Returns the body text of the notification.
+
+    \sa setMessage()
+*/
+QString QNotificationRequest::message() const
+{
+    return d->message;
+}
+
+/*!
+    Sets the body text of the notification to \a message.
+
+    \sa message()
+*/
+void QNotificationRequest::setMessage(const QString &message)
+{
+    d->message = message;
+}
+
+/*!
+    Returns the urgency of the notification. The default is \l Normal.
+
+    \sa setUrgency()
+*/
+QNotificationRequest::Urgency QNotificationRequest::urgency() const
+{
+    return d->urgency;
+}
+
+/*!
+    Sets the urgency of the notification to \a urgency.
+
+    \sa urgency()
+*/
+void QNotificationRequest::setUrgency(Urgency urgency)
+{
+    d->urgency = urgency;
+}
+
+/*!
+    Returns the category of the notification.
+
+    \sa setCategory()
+*/
+QString QNotificationRequest::category() const
+{
+    return d->category;
+}
+
+/*!
+    Sets the category of the notification to \a category.
+
+    Categories group notifications of the same kind, such as \c "email.arrived" or
+    \c "device.error". On Linux, the category is passed to the notification server
+    as the \c category hint. QNotifications applies rate limits per category.
+
+    \sa category(), QNotifications::setRateLimit()
+*/
+void QNotificationRequest::setCategory(const QString &category)
+{
+    d->category = category;
+}
+
+/*!
+    Returns the group of the notification.
+
+    \sa setGroup()
+*/
+QString QNotificationRequest::group() const
+{
+    return d->group;
+}
+
+/*!
+    Sets the group of the notification to \a group.
+
+    Groups gather notifications about the same subject, such as the messages of
+    one chat channel. When a group threshold is set, QNotifications collapses a
+    group with too many notifications shown into a single summary notification.
+    Notifications without a group are never collapsed.
+
+    \sa group(), QNotifications::groupThreshold
+*/
+void QNotificationRequest::setGroup(const QString &group)
+{
+    d->group = group;
+}
+
+/*!
+    Returns the time in milliseconds after which the notification expires.
+
+    The default is \c -1, which leaves the decision to the platform. \c 0 means
+    that the notification never expires.
+
+    \sa setExpireTimeout()
+*/
+int QNotificationRequest::expireTimeout() const
+{
+    return d->expireTimeout;
+}
+
+/*!
+    Sets the expiration timeout of the notification to \a milliseconds.
+
+    \sa expireTimeout()
+*/
+void QNotificationRequest::setExpireTimeout(int milliseconds)
+{
+    d->expireTimeout = milliseconds;
+}
+
+/*!
+    Returns the time in milliseconds the platform has to accept the notification.
+
+    The default is \c -1, which uses the default of the engine.
+
+    \sa setSendTimeout(), QNotifications::sendTimeout
+*/
+int QNotificationRequest::sendTimeout() const
+{
+    return d->sendTimeout;
+}
+
+/*!
+    Sets the time the platform has to accept the notification to \a milliseconds.
+
+    On Linux, this is the timeout of the \c Notify call. A send that is not
+    answered in time fails, and its ID is \c 0. Unlike expireTimeout(), this has
+    no effect on how long the notification is shown.
+
+    \sa sendTimeout()
+*/
+void QNotificationRequest::setSendTimeout(int milliseconds)
+{
+    d->sendTimeout = milliseconds;
+}
+
+/*!
+    Returns the icon of the notification, as a file path or an icon name.
+
+    \sa setIcon()
+*/
+QString QNotificationRequest::icon() const
+{
+    return d->icon;
+}
+
+/*!
+    Sets the icon of the notification to \a icon, which is either a file path or,
+    on platforms that support it, an icon name.
+
+    \sa icon()
+*/
+void QNotificationRequest::setIcon(const QString &icon)
+{
+    d->icon = icon;
+}
+
+/*!
+    Returns the image of the notification.
+
+    \sa setImage()
+*/
+QImage QNotificationRequest::image() const
+{
+    return d->image;
+}
+
+/*!
+    Sets the image of the notification to \a image.
+
+    The image is implicitly shared: engines that can transfer pixel data read it
+    straight from the image's buffer, converting it only when the platform
+    requires a different pixel format.
+
+    \sa image()
+*/
+void QNotificationRequest::setImage(const QImage &image)
+{
+    d->image = image;
+}
+
+/*!
+    Returns the actions of the notification as a flat list, in the order they were
+    added: the key of the first action, followed by its label, then the key of the
+    second action, and so on.
+
+    \sa addAction(), actionCount()
+*/
+QStringList QNotificationRequest::actions() const
+{
+    return d->actions;
+}
+
+/*!
+    Returns the number of actions of the notification.
+
+    \sa addAction()
+*/
+qsizetype QNotificationRequest::actionCount() const
+{
+    return d->actions.size() / 2;
+}
+
+/*!
+    Adds an action identified by \a key and displayed as \a label.
+
+    The key is reported by QNotifications::actionInvoked() when the user
+    invokes the action.
+
+    \sa actions(), clearActions()
+*/
+void QNotificationRequest::addAction(const QString &key, const QString &label)
+{
+    d->actions.append(key);
+    d->actions.append(label);
+}
+
+/*!
+    Removes all actions from the notification.
+
+    \sa addAction()
+*/
+void QNotificationRequest::clearActions()
+{
+    d->actions.clear();
+}
+
+/*!
+    Returns the engine-specific hints of the notification.
+
+    Hints carry the parameters that only some engines understand, as described in
+    \l{Qt Notifications Engines}.
+
+    \sa setHints(), setHint()
+*/
+QVariantMap QNotificationRequest::hints() const
+{
+    return d->hints;
+}
+
+/*!
+    Replaces the engine-specific hints of the notification with \a hints.
+
+    \sa hints(), setHint()
+*/
+void QNotificationRequest::setHints(const QVariantMap &hints)
+{
+    d->hints = hints;
+}
+
+/*!
+    Sets the engine-specific hint \a key to \a value.
+
+    \sa hints()
+*/
+void QNotificationRequest::setHint(const QString &key, const QVariant &value)
+{
+    d->hints.insert(key, value);
+}
+
+/*!
+    Sets the parameter \a key to \a value, as if it were passed in the
+    \c parameters of QNotifications::sendNotification().
+
+    The keys every engine understands set the typed properties: \c icon,
+    \c urgency, \c category, \c group and \c expire-timeout, and \c image-data
+    or \c image holding a QImage. Any other key sets the hint \a key. This lets
+    a request be built from a map of parameters in a single pass.
+
+    \sa setHint(), {Qt Notifications Engines}
+*/
+void QNotificationRequest::setParameter(const QString &key, const QVariant &value)
+{
+    if (key == u"urgency")
+        d->urgency = Urgency(qBound(0, value.toInt(), 2));
+    else if (key == u"icon")
+        d->icon = value.toString();
+    else if (key == u"category")
+        d->category = value.toString();
+    else if (key == u"group")
+        d->group = value.toString();
+    else if (key == u"expire-timeout")
+        d->expireTimeout = value.toInt();
+    else if ((key == u"image-data" || key == u"image") && value.typeId() == QMetaType::QImage)
+        d->image = value.value<QImage>();
+    else
+        d->hints.insert(key, value);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qnotificationrequest.cpp"
@@ -0,0 +1,84 @@
+#ifndef QNOTIFICATIONREQUEST_H
+#define QNOTIFICATIONREQUEST_H
+
+#include <QtNotifications/qnotifications_global.h>
+#include <QtCore/qobjectdefs.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+#include <QtGui/qimage.h>
+
+QT_BEGIN_NAMESPACE
+
+class QNotificationRequestPrivate;
+QT_DECLARE_QSDP_SPECIALIZATION_DTOR_WITH_EXPORT(QNotificationRequestPrivate, Q_NOTIFICATIONS_EXPORT)
+
+class Q_NOTIFICATIONS_EXPORT QNotificationRequest
+{
+    Q_GADGET
+
+public:
+    enum Urgency {
+        Low,
+        Normal,
+        Critical
+    };
+    Q_ENUM(Urgency)
+
+    QNotificationRequest();
+    QNotificationRequest(const QString &title, const QString &message);
+    QNotificationRequest(const QNotificationRequest &other);
+    QNotificationRequest(QNotificationRequest &&other) noexcept = default;
+    QNotificationRequest &operator=(const QNotificationRequest &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QNotificationRequest)
+    ~QNotificationRequest();
+
+    void swap(QNotificationRequest &other) noexcept { d.swap(other.d); }
+
+    QString title() const;
+    void setTitle(const QString &title);
+
+    QString message() const;
+    void setMessage(const QString &message);
+
+    Urgency urgency() const;
+    void setUrgency(Urgency urgency);
+
+    QString category() const;
+    void setCategory(const QString &category);
+
+    QString group() const;
+    void setGroup(const QString &group);
+
+    int expireTimeout() const;
+    void setExpireTimeout(int milliseconds);
+
+    int sendTimeout() const;
+    void setSendTimeout(int milliseconds);
+
+    QString icon() const;
+    void setIcon(const QString &icon);
+
+    QImage image() const;
+    void setImage(const QImage &image);
+
+    QStringList actions() const;
+    qsizetype actionCount() const;
+    void addAction(const QString &key, const QString &label);
+    void clearActions();
+
+    QVariantMap hints() const;
+    void setHints(const QVariantMap &hints);
+    void setHint(const QString &key, const QVariant &value);
+    void setParameter(const QString &key, const QVariant &value);
+
+private:
+    QSharedDataPointer<QNotificationRequestPrivate> d;
+};
+
+Q_DECLARE_SHARED(QNotificationRequest)
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONREQUEST_H
@@ -1,5 +1,16 @@
 #include "qnotifications.h"
+#include "qnotifications_p.h"
 #include "qplatformnotificationengine.h"
+#include "qnotificationjournal_p.h"
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QMetaMethod>
+#include <QtCore/QTimer>
+#include <QtCore/private/qtrace_p.h>
+
+#include <limits>
+#include <utility>
+
+#include <qtnotifications_tracepoints_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -37,6 +48,149 @@ QT_BEGIN_NAMESPACE
     \endcode
 
     When an action is invoked, the \l actionInvoked() signal is emitted.
+
+    \section1 Typed Requests
+
+    Every send function also accepts a QNotificationRequest, which carries the
+    properties understood by all engines as typed values and keeps the actions in
+    the order they were added. Sending a QNotificationRequest avoids building and
+    parsing parameter maps for every notification.
+
+    \code
+    QNotificationRequest request("Title", "Message");
+    request.setUrgency(QNotificationRequest::Critical);
+    request.addAction("open", "Open");
+    notifications.sendNotification(request);
+    \endcode
+
+    \section1 Asynchronous Sending
+
+    sendNotification() waits for the platform to assign an ID, which on some
+    platforms means a round trip to the notification server. Use
+    sendNotificationAsync() to keep the calling thread responsive, or
+    postNotification() when the ID is not needed at all.
+
+    \code
+    QFuture<uint> future = notifications.sendNotificationAsync("Title", "Message");
+    future.then(this, [](uint notificationId) {
+        qDebug() << "Notification sent with ID" << notificationId;
+    });
+    \endcode
+
+    \section1 Batching
+
+    Bursts of notifications can be sent with sendNotifications(), which hands all
+    requests to the platform at once. On Linux, every \c Notify call is written to
+    the D-Bus connection before any reply is awaited, so the total latency is
+    bounded by the notification server rather than by one round trip per
+    notification.
+
+    \code
+    QList<QNotificationRequest> requests;
+    for (const Alert &alert : alerts)
+        requests.append(QNotificationRequest(alert.title, alert.text));
+    notifications.sendNotifications(requests).then(this, [](const QList<uint> &ids) {
+        qDebug() << "Sent" << ids.size() << "notifications";
+    });
+    \endcode
+
+    When batching is enabled with setBatchingEnabled(), calls to
+    sendNotificationAsync() made during the same event loop iteration are
+    collected and sent as one batch.
+
+    \section1 Send Queue
+
+    With setMaximumInFlight(), only a limited number of asynchronous sends wait
+    for the platform at a time; the others are queued by urgency. The
+    queueDepthChanged() and backpressure() signals tell producers when the
+    platform cannot keep up.
+
+    \code
+    notifications.setMaximumInFlight(8);
+    connect(&notifications, &QNotifications::backpressure, this, [this](bool active) {
+        m_coalesceAlerts = active;
+    });
+    \endcode
+
+    \section1 Sending from Other Threads
+
+    QNotifications is not thread-safe in general, with one exception:
+    submitNotification() may be called from any thread, for instance from
+    QThreadPool jobs, without synchronizing with the thread QNotifications lives
+    in.
+
+    \code
+    QThreadPool::globalInstance()->start([&notifications, report] {
+        notifications.submitNotification(QNotificationRequest("Report ready", report.name()))
+                .then(&notifications, [](uint notificationId) { ... });
+    });
+    \endcode
+
+    \section1 Rate Limiting
+
+    An application that reports events of an external system, such as a flapping
+    network link, can produce far more notifications than the user, or the
+    notification server, can handle. setRateLimit() caps the rate of notifications
+    per QNotificationRequest::category() with a token bucket. Notifications over the
+    limit are not sent individually; instead, a single summary notification reports
+    how many were left out, and is updated in place while more of them arrive.
+
+    \code
+    notifications.setRateLimit(QStringLiteral("network"), 1.0, 5);
+    \endcode
+
+    \section1 Deduplication
+
+    The same event is often reported more than once in quick succession, for
+    instance by a job that retries. setDeduplication() keeps notifications with
+    the same title, message and category from piling up: within a time window,
+    repeats are either dropped or counted in the title of the notification they
+    repeat.
+
+    \code
+    notifications.setDeduplication(QNotifications::ReplaceDuplicates, 10000);
+    \endcode
+
+    \section1 Grouping
+
+    A chat client would show a notification for every message, stacking up
+    popups and notification server memory while a channel is busy. Requests
+    tagged with a QNotificationRequest::group() are instead collapsed into one
+    summary notification once more than groupThreshold of them are shown:
+
+    \code
+    notifications.setGroupThreshold(3);
+
+    QNotificationRequest request(message.sender(), message.text());
+    request.setGroup(QStringLiteral("#ops"));
+    notifications.sendNotificationAsync(request);
+    \endcode
+
+    \section1 Recovering After a Restart
+
+    Notifications outlive the application that sent them. With a journal opened by
+    openJournal(), the next run of the application learns which of its
+    notifications may still be shown, as long as the notification server that
+    showed them is still running, and can take them over:
+
+    \code
+    QNotifications notifications;
+    notifications.openJournal();
+    notifications.adoptOutstandingNotifications();
+    \endcode
+
+    \section1 Selecting an Engine
+
+    By default, QNotifications uses the native engine of the platform. A different
+    engine can be chosen with the \c QT_NOTIFICATIONS_ENGINE environment variable,
+    or per instance by passing its name to the constructor. availableEngines()
+    lists the engines known to the running application.
+
+    \code
+    QNotifications loopback(QStringLiteral("loopback"));
+    \endcode
+
+    See \l{Qt Notifications Engines} for the list of engines.
 */
 
 /*!
@@ -58,6 +212,7 @@ QT_BEGIN_NAMESPACE
     \fn QNotifications::actionInvoked(uint notificationId, const QString &actionKey)
 
     This signal is emitted when a notification action is invoked by the user.
+    It is only emitted for notifications sent through this object.
 
     \a notificationId is the ID of the notification that triggered the action.
     \a actionKey is the key of the action that was invoked, as specified in the
@@ -70,6 +225,7 @@ QT_BEGIN_NAMESPACE
     \fn QNotifications::notificationClosed(uint notificationId, ClosedReason reason)
 
     This signal is emitted when a notification is closed by the user or the system.
+    It is only emitted for notifications sent through this object.
 
     \a notificationId is the ID of the notification that was closed.
     \a reason is the reason for the notification being closed.
@@ -77,28 +233,753 @@ QT_BEGIN_NAMESPACE
     \sa sendNotification()
 */
 
+/*!
+    \fn QNotifications::notificationPosted(uint notificationId, const QNotificationRequest &request, uint replacedId)
+
+    This signal is emitted when the notification described by \a request has
+    been accepted by the platform and is identified by \a notificationId. It is
+    emitted for notifications sent, and for updates made with
+    updateNotification(), through this object, including the summaries of rate
+    limits and groups. It is not emitted for notifications sent with
+    postNotification() or submitNotification(), whose IDs are not delivered to
+    this object.
+
+    Together with notificationClosed(), this signal lets an application mirror
+    the notifications it shows, for instance in an in-app notification center.
+    The IDs of notifications sent while the signal is not connected are not
+    tracked.
+
+    For an update, \a replacedId is the ID of the notification that was
+    updated. It differs from \a notificationId when the platform showed the
+    update as a new notification, for instance because the old one had been
+    closed meanwhile. For a new notification, \a replacedId is \c 0.
+
+    \sa notificationClosed()
+*/
+
+/*!
+    \fn QNotifications::capabilitiesChanged()
+
+    This signal is emitted when the capabilities reported by the notification
+    server have been fetched or have become invalid.
+
+    \sa capabilities
+*/
+
+/*!
+    \fn QNotifications::availabilityChanged(bool available)
+
+    This signal is emitted when a notification server appears or disappears.
+    \a available is the new value of the \l available property.
+*/
+
+/*!
+    \fn QNotifications::queueDepthChanged(int depth)
+
+    This signal is emitted when the number of requests in the send queue changes.
+    \a depth is the new value of the \l queueDepth property.
+*/
+
+/*!
+    \fn QNotifications::backpressure(bool active)
+
+    This signal is emitted with \a active set to \c true when the send queue
+    grows to \l backpressureThreshold requests, and with \a active set to
+    \c false once it has drained to half that number.
+
+    Producers of notifications can use it to slow down at the source, for
+    example by merging events into fewer notifications while the platform is
+    saturated.
+
+    \sa maximumInFlight
+*/
+
+/*!
+    \fn QNotifications::circuitStateChanged(QNotifications::CircuitState state)
+
+    This signal is emitted when the engine's circuit breaker changes to \a state.
+
+    \sa circuitState
+*/
+
 /*!
     \fn QNotifications::notificationClicked(uint notificationId)
 
     This signal is emitted when a notification is clicked by the user.
+    It is only emitted for notifications sent through this object.
 
     \a notificationId is the ID of the notification that was clicked.
 
     \sa sendNotification()
 */
 
+QNotificationRequest QNotificationsPrivate::requestFromParameters(const QString &title,
+                                                                const QString &message,
+                                                                const QVariantMap &parameters,
+                                                                const QMap<QString, QString> &actions)
+{
+    QNotificationRequest request(title, message);
+
+    // Lift the keys every engine understands into typed fields and keep
+    // the engine-specific rest as hints
+    for (auto it = parameters.constBegin(); it != parameters.constEnd(); ++it)
+        request.setParameter(it.key(), it.value());
+
+    for (auto it = actions.constBegin(); it != actions.constEnd(); ++it)
+        request.addAction(it.key(), it.value());
+    return request;
+}
+
+QFuture<uint> QNotificationsPrivate::enqueueBatched(const QNotificationRequest &request)
+{
+    Q_Q(QNotifications);
+    auto promise = std::make_shared<QPromise<uint>>();
+    QFuture<uint> future = promise->future();
+    promise->start();
+
+    // The first request of an event loop iteration schedules the flush
+    if (batch.isEmpty())
+        QMetaObject::invokeMethod(q, [this] { flushBatch(); }, Qt::QueuedConnection);
+    batch.append({request, std::move(promise)});
+    return future;
+}
+
+void QNotificationsPrivate::flushBatch()
+{
+    Q_Q(QNotifications);
+    if (batch.isEmpty())
+        return;
+
+    const QList<PendingSend> pending = std::exchange(batch, {});
+    QList<QNotificationRequest> requests;
+    requests.reserve(pending.size());
+    for (const PendingSend &send : pending)
+        requests.append(send.request);
+
+    engine->sendOwnedNotifications(requests, q).then(q, [pending](const QList<uint> &ids) {
+        for (qsizetype i = 0; i < pending.size(); ++i) {
+            pending.at(i).promise->addResult(ids.value(i));
+            pending.at(i).promise->finish();
+        }
+    });
+}
+
+QFuture<uint> QNotificationsPrivate::enqueuePrioritized(const QNotificationRequest &request)
+{
+    auto promise = std::make_shared<QPromise<uint>>();
+    QFuture<uint> future = promise->future();
+    promise->start();
+    sendQueues[qBound(0, int(request.urgency()), int(sendQueues.size()) - 1)].append({request, std::move(promise)});
+    ++queueDepth;
+    dispatchQueued();
+    onQueueDepthChanged();
+    return future;
+}
+
+void QNotificationsPrivate::dispatchQueued()
+{
+    Q_Q(QNotifications);
+    QList<PendingSend> released;
+    for (auto queue = sendQueues.rbegin(); queue != sendQueues.rend(); ++queue) {
+        while (!queue->isEmpty() && (maximumInFlight <= 0 || inFlight + released.size() < maximumInFlight)) {
+            PendingSend send = queue->takeFirst();
+            --queueDepth;
+            // The caller gave up on the notification while it was queued
+            if (send.promise->isCanceled()) {
+                send.promise->finish();
+                continue;
+            }
+            released.append(std::move(send));
+        }
+    }
+    if (released.isEmpty())
+        return;
+
+    inFlight += released.size();
+    const qint64 startedAt = engine->recordSendStarted(released.size());
+    if (released.size() == 1) {
+        const PendingSend send = released.constFirst();
+        trackNotification(engine->sendOwnedNotificationAsync(send.request, q), startedAt, send.request)
+                .then(q, [this, send](uint notificationId) {
+            send.promise->addResult(notificationId);
+            send.promise->finish();
+            --inFlight;
+            dispatchQueued();
+            onQueueDepthChanged();
+        });
+        return;
+    }
+
+    // Requests released together are sent together
+    QList<QNotificationRequest> requests;
+    requests.reserve(released.size());
+    for (const PendingSend &send : std::as_const(released))
+        requests.append(send.request);
+    trackNotifications(engine->sendOwnedNotifications(requests, q), startedAt, requests)
+            .then(q, [this, released](const QList<uint> &notificationIds) {
+        for (qsizetype i = 0; i < released.size(); ++i) {
+            released.at(i).promise->addResult(notificationIds.value(i));
+            released.at(i).promise->finish();
+        }
+        inFlight -= released.size();
+        dispatchQueued();
+        onQueueDepthChanged();
+    });
+}
+
+void QNotificationsPrivate::onQueueDepthChanged()
+{
+    Q_Q(QNotifications);
+    if (queueDepth == reportedQueueDepth)
+        return;
+    reportedQueueDepth = queueDepth;
+    emit q->queueDepthChanged(int(queueDepth));
+
+    // Released once the queue has drained to half the threshold, so that a
+    // producer does not toggle on every single send
+    if (!backpressureActive && queueDepth >= backpressureThreshold) {
+        backpressureActive = true;
+        emit q->backpressure(true);
+    } else if (backpressureActive && queueDepth <= backpressureThreshold / 2) {
+        backpressureActive = false;
+        emit q->backpressure(false);
+    }
+}
+
+// Notifications remembered for deduplication at most, so that memory stays bounded
+// however many distinct notifications are sent within the window
+static constexpr qsizetype MaximumRecentNotifications = 1024;
+
+size_t QNotificationsPrivate::deduplicationKey(const QNotificationRequest &request)
+{
+    return qHashMulti(QHashSeed::globalSeed(), request.title(), request.message(), request.category());
+}
+
+void QNotificationsPrivate::expireRecent(qint64 now)
+{
+    // Notifications are remembered in the order they were first seen, so the
+    // expired ones are at the front
+    while (!recentOrder.isEmpty()
+           && (now - recentOrder.constFirst().second >= deduplicationWindow
+               || recent.size() > MaximumRecentNotifications)) {
+        const auto [key, seenAt] = recentOrder.takeFirst();
+        if (const auto it = recent.constFind(key); it != recent.cend() && it->seenAt == seenAt) {
+            recentIds.remove(it->notificationId);
+            recent.erase(it);
+        }
+    }
+}
+
+static bool isSameNotification(const QNotificationRequest &a, const QNotificationRequest &b)
+{
+    return a.title() == b.title() && a.message() == b.message() && a.category() == b.category();
+}
+
+bool QNotificationsPrivate::isDuplicate(const QNotificationRequest &request)
+{
+    if (!deduplicationClock.isValid())
+        deduplicationClock.start();
+    const qint64 now = deduplicationClock.elapsed();
+    const size_t key = deduplicationKey(request);
+    expireRecent(now);
+
+    const auto it = recent.find(key);
+    if (it == recent.end()) {
+        recent.insert(key, { request, now });
+        recentOrder.append({ key, now });
+        expireRecent(now);
+        return false;
+    }
+
+    // A hash collision must not swallow a different notification
+    if (!isSameNotification(it->request, request))
+        return false;
+
+    ++duplicateCount;
+    ++it->count;
+    if (deduplicationMode == QNotifications::ReplaceDuplicates) {
+        // The first notification may still be waiting for its ID
+        if (it->notificationId != 0)
+            bumpDuplicate(key, *it);
+        else
+            it->bumpPending = true;
+    }
+    return true;
+}
+
+void QNotificationsPrivate::bumpDuplicate(size_t key, RecentNotification &entry)
+{
+    Q_Q(QNotifications);
+    QNotificationRequest bumped = entry.request;
+    bumped.setTitle(QNotifications::tr("%1 (%2)").arg(entry.request.title()).arg(entry.count));
+    entry.bumpPending = false;
+    q->updateNotification(entry.notificationId, bumped).then(q, [this, key](uint notificationId) {
+        // The platform assigns a new ID if the notification was closed meanwhile
+        const auto it = recent.find(key);
+        if (it == recent.end() || notificationId == 0 || it->notificationId == notificationId)
+            return;
+        recentIds.remove(it->notificationId);
+        recentIds.insert(notificationId, key);
+        it->notificationId = notificationId;
+    });
+}
+
+// Forgets a notification that was remembered when it was admitted, but that
+// was not shown after all, so that repeating it is not taken for a duplicate
+void QNotificationsPrivate::forgetRecent(const QNotificationRequest &request)
+{
+    if (deduplicationMode == QNotifications::NoDeduplication)
+        return;
+    const auto it = recent.constFind(deduplicationKey(request));
+    if (it != recent.cend() && it->notificationId == 0 && isSameNotification(it->request, request))
+        recent.erase(it);
+}
+
+bool QNotificationsPrivate::isPostedSignalConnected() const
+{
+    Q_Q(const QNotifications);
+    static const QMetaMethod postedSignal = QMetaMethod::fromSignal(&QNotifications::notificationPosted);
+    return q->isSignalConnected(postedSignal);
+}
+
+void QNotificationsPrivate::onNotificationPosted(const QNotificationRequest &request, uint notificationId,
+                                                 bool update, uint replacedId)
+{
+    Q_Q(QNotifications);
+    if (notificationId == 0) {
+        if (!update)
+            forgetRecent(request);
+        return;
+    }
+    if (!update)
+        onNotificationSent(request, notificationId);
+    emit q->notificationPosted(notificationId, request, replacedId);
+}
+
+void QNotificationsPrivate::onNotificationSent(const QNotificationRequest &request, uint notificationId)
+{
+    if (groupThreshold > 0 && !request.group().isEmpty())
+        addToGroup(request, notificationId);
+    if (deduplicationMode == QNotifications::NoDeduplication)
+        return;
+    const size_t key = deduplicationKey(request);
+    const auto it = recent.find(key);
+    if (it == recent.end() || it->notificationId != 0 || !isSameNotification(it->request, request))
+        return;
+    it->notificationId = notificationId;
+    recentIds.insert(notificationId, key);
+    if (it->bumpPending)
+        bumpDuplicate(key, *it);
+}
+
+bool QNotificationsPrivate::collapseIntoGroup(const QNotificationRequest &request)
+{
+    if (request.group().isEmpty())
+        return false;
+    const auto it = groups.find(request.group());
+    if (it == groups.end() || it->collapsed == 0)
+        return false;
+    ++it->collapsed;
+    it->last = request;
+    sendGroupSummary(it.key());
+    return true;
+}
+
+void QNotificationsPrivate::addToGroup(const QNotificationRequest &request, uint notificationId)
+{
+    Q_Q(QNotifications);
+    const QString group = request.group();
+    GroupState &state = groups[group];
+    state.last = request;
+    if (state.collapsed != 0) {
+        // Sent while the group was collapsing, so the summary takes it over
+        ++state.collapsed;
+        q->closeNotification(notificationId);
+        sendGroupSummary(group);
+        return;
+    }
+
+    state.live.append(notificationId);
+    notificationGroups.insert(notificationId, group);
+    if (state.live.size() <= groupThreshold)
+        return;
+
+    // Too many notifications of the group are shown; replace them with a summary
+    const QList<uint> live = std::exchange(state.live, {});
+    for (uint liveId : live)
+        notificationGroups.remove(liveId);
+    state.collapsed = live.size();
+    q->closeNotifications(live);
+    sendGroupSummary(group);
+}
+
+void QNotificationsPrivate::sendGroupSummary(const QString &group)
+{
+    GroupState &state = groups[group];
+    // The summary is sent again once the engine has replied
+    if (state.summary.sending) {
+        state.summary.stale = true;
+        return;
+    }
+
+    QNotificationRequest summary(QNotifications::tr("%n new notification(s) from %1", nullptr,
+                                                    int(qMin<quint64>(state.collapsed, std::numeric_limits<int>::max())))
+                                         .arg(group),
+                                 state.last.title());
+    summary.setCategory(state.last.category());
+    summary.setUrgency(state.last.urgency());
+    summary.setIcon(state.last.icon());
+    showSummary(SummaryKind::Group, group, summary);
+}
+
+QNotificationsPrivate::Summary *QNotificationsPrivate::findSummary(SummaryKind kind, const QString &key)
+{
+    if (kind == SummaryKind::Category) {
+        const auto it = categories.find(key);
+        return it == categories.end() ? nullptr : &it->summary;
+    }
+    const auto it = groups.find(key);
+    return it == groups.end() ? nullptr : &it->summary;
+}
+
+void QNotificationsPrivate::showSummary(SummaryKind kind, const QString &key, const QNotificationRequest &request)
+{
+    Q_Q(QNotifications);
+    Summary *summary = findSummary(kind, key);
+    Q_ASSERT(summary && !summary->sending);
+    summary->sending = true;
+
+    // The summary is updated in place once it has an ID
+    const uint replacedId = summary->notificationId;
+    const qint64 startedAt = engine->recordSendStarted();
+    QFuture<uint> future = replacedId != 0
+            ? trackNotification(engine->updateOwnedNotification(replacedId, request, q), startedAt, request, true, replacedId)
+            : trackNotification(engine->sendOwnedNotificationAsync(request, q), startedAt, request);
+    future.then(q, [this, kind, key](uint notificationId) {
+        Summary *summary = findSummary(kind, key);
+        if (!summary)
+            return;
+        summary->sending = false;
+        // The platform may show an update as a new notification, with a new ID;
+        // a failed update leaves the summary shown as it was
+        if (notificationId != 0 && notificationId != summary->notificationId) {
+            summaryIds.remove(summary->notificationId);
+            summaryIds.insert(notificationId, { kind, key });
+            summary->notificationId = notificationId;
+        }
+        if (!std::exchange(summary->stale, false))
+            return;
+        if (kind == SummaryKind::Group)
+            sendGroupSummary(key);
+        else if (!summaryTimer->isActive())
+            summaryTimer->start();
+    });
+}
+
+// Summaries of suppressed notifications are sent or updated at most this often
+static constexpr int SummaryInterval = 1000;
+// Category states are not pruned while there are fewer than this
+static constexpr qsizetype MinimumCategoryPruneSize = 64;
+
+bool QNotificationsPrivate::admit(const QNotificationRequest &request)
+{
+    if (deduplicationMode != QNotifications::NoDeduplication && isDuplicate(request))
+        return false;
+    if (groupThreshold > 0 && collapseIntoGroup(request)) {
+        forgetRecent(request);
+        return false;
+    }
+    if (rateLimits.isEmpty())
+        return true;
+
+    const QString category = request.category();
+    auto limit = rateLimits.constFind(category);
+    if (limit == rateLimits.cend())
+        limit = rateLimits.constFind(QString());
+    if (limit == rateLimits.cend())
+        return true;
+
+    const qint64 now = rateLimitClock.nsecsElapsed();
+    auto it = categories.find(category);
+    if (it == categories.end()) {
+        // Categories seen once would otherwise accumulate, so idle ones are
+        // pruned whenever the number of states has doubled
+        if (categories.size() >= categoryPruneSize) {
+            pruneCategories(now);
+            categoryPruneSize = qMax<qsizetype>(MinimumCategoryPruneSize, 2 * categories.size());
+        }
+        it = categories.insert(category, CategoryState());
+    }
+    CategoryState &state = it.value();
+    if (state.lastRefill < 0) {
+        state.tokens = limit->burst;
+    } else {
+        const double elapsed = (now - state.lastRefill) / 1e9;
+        state.tokens = qMin<double>(limit->burst, state.tokens + elapsed * limit->rate);
+    }
+    state.lastRefill = now;
+
+    if (state.tokens >= 1) {
+        state.tokens -= 1;
+        return true;
+    }
+
+    // Fold the notification into the summary of its category
+    forgetRecent(request);
+    ++suppressedCount;
+    ++state.unreported;
+    state.lastTitle = request.title();
+    state.lastIcon = request.icon();
+    state.lastUrgency = request.urgency();
+    if (!summaryTimer->isActive())
+        summaryTimer->start();
+    return false;
+}
+
+void QNotificationsPrivate::pruneCategories(qint64 now)
+{
+    // A category whose bucket has refilled and that shows no summary is in the
+    // same state as one that was never seen
+    categories.removeIf([this, now](const auto &entry) {
+        const CategoryState &state = entry.value();
+        if (state.unreported != 0 || state.summary.notificationId != 0 || state.summary.sending)
+            return false;
+        auto limit = rateLimits.constFind(entry.key());
+        if (limit == rateLimits.cend())
+            limit = rateLimits.constFind(QString());
+        if (limit == rateLimits.cend())
+            return true;
+        const double elapsed = (now - state.lastRefill) / 1e9;
+        return state.tokens + elapsed * limit->rate >= limit->burst;
+    });
+}
+
+void QNotificationsPrivate::sendSummaries()
+{
+    for (auto it = categories.begin(); it != categories.end(); ++it) {
+        CategoryState &state = it.value();
+        if (state.unreported == 0)
+            continue;
+        // The summary is sent again once the engine has replied
+        if (state.summary.sending) {
+            state.summary.stale = true;
+            continue;
+        }
+
+        const quint64 total = state.reported + state.unreported;
+        QNotificationRequest summary(QNotifications::tr("%n more event(s)", nullptr, int(qMin<quint64>(total, std::numeric_limits<int>::max()))),
+                                     state.lastTitle);
+        summary.setCategory(it.key());
+        summary.setUrgency(state.lastUrgency);
+        summary.setIcon(state.lastIcon);
+        summarizedCount += state.unreported;
+        state.reported = total;
+        state.unreported = 0;
+        showSummary(SummaryKind::Category, it.key(), summary);
+    }
+}
+
+QFuture<uint> QNotificationsPrivate::trackNotification(QFuture<uint> future, qint64 startedAt,
+                                                      const QNotificationRequest &request, bool update,
+                                                      uint replacedId)
+{
+    Q_Q(QNotifications);
+    // The engine registers the owner before the future finishes; the
+    // continuations below may run in the engine's thread, so they reach the
+    // owner only through the engine, which knows whether it still exists
+    QPlatformNotificationEngine *engine = this->engine;
+    QNotifications *owner = q;
+    std::shared_ptr<QNotificationJournal> journal = this->journal;
+    // Deduplication, grouping and notificationPosted() need the IDs of the
+    // notifications sent; deduplication needs to know of failed sends too
+    const bool observing = isPostedSignalConnected()
+            || (!update && (deduplicationMode != QNotifications::NoDeduplication || groupThreshold > 0));
+    const bool observingFailures = !update && deduplicationMode != QNotifications::NoDeduplication;
+    const auto post = [engine, owner, request, update, replacedId](uint notificationId) {
+        engine->invokeOnOwner(owner, [owner, request, notificationId, update, replacedId] {
+            owner->d_func()->onNotificationPosted(request, notificationId, update, replacedId);
+        });
+    };
+    return future.then(QtFuture::Launch::Sync, [engine, journal, request, startedAt, update,
+                                                observing, observingFailures, post](uint notificationId) {
+        if (update)
+            engine->recordUpdateFinished(startedAt, notificationId != 0);
+        else
+            engine->recordSendFinished(startedAt, notificationId != 0 ? 1 : 0, notificationId != 0 ? 0 : 1);
+        if (journal)
+            journal->append(notificationId, notificationId != 0 ? QNotificationJournal::Sent : QNotificationJournal::Failed, request.category());
+        if (notificationId != 0 ? observing : observingFailures)
+            post(notificationId);
+        return notificationId;
+    }).onCanceled([engine, startedAt, update, observingFailures, post] {
+        if (update)
+            engine->recordUpdateFinished(startedAt, false);
+        else
+            engine->recordSendFinished(startedAt, 0, 1);
+        if (observingFailures)
+            post(0);
+        return 0u;
+    });
+}
+
+QFuture<QList<uint>> QNotificationsPrivate::trackNotifications(QFuture<QList<uint>> future, qint64 startedAt,
+                                                              const QList<QNotificationRequest> &requests)
+{
+    Q_Q(QNotifications);
+    QPlatformNotificationEngine *engine = this->engine;
+    QNotifications *owner = q;
+    std::shared_ptr<QNotificationJournal> journal = this->journal;
+    const bool observing = isPostedSignalConnected()
+            || deduplicationMode != QNotifications::NoDeduplication || groupThreshold > 0;
+    return future.then(QtFuture::Launch::Sync, [engine, owner, journal, requests, startedAt, observing](const QList<uint> &notificationIds) {
+        const qsizetype sent = notificationIds.size() - notificationIds.count(0u);
+        engine->recordSendFinished(startedAt, sent, notificationIds.size() - sent);
+        if (journal) {
+            for (qsizetype i = 0; i < notificationIds.size(); ++i) {
+                const uint notificationId = notificationIds.at(i);
+                journal->append(notificationId, notificationId != 0 ? QNotificationJournal::Sent : QNotificationJournal::Failed,
+                                requests.value(i).category());
+            }
+        }
+        if (observing) {
+            engine->invokeOnOwner(owner, [owner, requests, notificationIds] {
+                for (qsizetype i = 0; i < notificationIds.size(); ++i)
+                    owner->d_func()->onNotificationPosted(requests.value(i), notificationIds.at(i), false, 0);
+            });
+        }
+        return notificationIds;
+    }).onCanceled([engine, owner, requests, startedAt, observing] {
+        engine->recordSendFinished(startedAt, 0, requests.size());
+        if (observing) {
+            engine->invokeOnOwner(owner, [owner, requests] {
+                for (const QNotificationRequest &request : requests)
+                    owner->d_func()->onNotificationPosted(request, 0, false, 0);
+            });
+        }
+        return QList<uint>(requests.size(), 0u);
+    });
+}
+
+void QNotificationsPrivate::onServerIdentityChanged(const QString &serverIdentity)
+{
+    // The IDs recorded so far were assigned by a server that is gone
+    outstanding.clear();
+    if (journal)
+        journal->reset(serverIdentity);
+
+    // So were the summaries; the next one is sent anew and counts from zero.
+    // A summary in flight takes whatever ID its reply brings
+    summaryIds.clear();
+    for (CategoryState &state : categories) {
+        state.summary.notificationId = 0;
+        state.reported = 0;
+    }
+
+    // Groups are shown one by one again, except those whose summary is in
+    // flight and still reports what it collapsed
+    notificationGroups.clear();
+    groups.removeIf([](const auto &entry) { return !entry.value().summary.sending; });
+    for (GroupState &state : groups) {
+        state.live.clear();
+        state.summary.notificationId = 0;
+    }
+
+    // Notifications that are no longer shown cannot take in their duplicates;
+    // those still waiting for their ID may be shown by the new server
+    recent.removeIf([](const auto &entry) { return entry.value().notificationId != 0; });
+    recentIds.clear();
+}
+
+void QNotificationsPrivate::onNotificationClosed(uint notificationId)
+{
+    if (journal)
+        journal->append(notificationId, QNotificationJournal::Closed);
+
+    // A notification that is no longer shown cannot take in its duplicates
+    if (const auto key = recentIds.constFind(notificationId); key != recentIds.cend()) {
+        if (const auto it = recent.constFind(*key); it != recent.cend() && it->notificationId == notificationId)
+            recent.erase(it);
+        recentIds.erase(key);
+    }
+
+    if (const auto summary = summaryIds.constFind(notificationId); summary != summaryIds.cend()) {
+        const auto [kind, key] = *summary;
+        summaryIds.erase(summary);
+        if (kind == SummaryKind::Category) {
+            // Once a summary is gone, the next one starts counting from zero
+            if (const auto it = categories.find(key); it != categories.end()) {
+                it->summary.notificationId = 0;
+                it->reported = 0;
+            }
+        } else {
+            // Once the summary of a group is gone, its notifications are shown
+            // one by one again
+            groups.remove(key);
+        }
+        return;
+    }
+
+    const auto group = notificationGroups.constFind(notificationId);
+    if (group == notificationGroups.cend())
+        return;
+    const auto it = groups.find(*group);
+    notificationGroups.erase(group);
+    if (it == groups.end())
+        return;
+    it->live.removeOne(notificationId);
+    if (it->live.isEmpty() && it->collapsed == 0)
+        groups.erase(it);
+}
+
+/*!
+    Constructs a QNotifications object with the given \a parent, using the
+    default notification engine.
+
+    The default engine is the native engine of the platform, unless another one
+    is named by the \c QT_NOTIFICATIONS_ENGINE environment variable. On
+    platforms without a native engine, isSupported() returns \c false unless an
+    engine is named.
+*/
 QNotifications::QNotifications(QObject *parent)
-    : QObject(parent)
-    , m_engine(qt_notification_engine())
+    : QNotifications(QString(), parent)
+{
+}
+
+/*!
+    Constructs a QNotifications object with the given \a parent, using the
+    notification engine called \a engineName.
+
+    If no engine with that name is available, isSupported() returns \c false.
+
+    \sa availableEngines()
+*/
+QNotifications::QNotifications(const QString &engineName, QObject *parent)
+    : QObject(*new QNotificationsPrivate, parent)
 {
-    if (m_engine) {
-        connect(m_engine, &QPlatformNotificationEngine::actionInvoked, this, &QNotifications::actionInvoked);
-        connect(m_engine, &::QPlatformNotificationEngine::notificationClosed, this, &QNotifications::notificationClosed);
-        connect(m_engine, &QPlatformNotificationEngine::notificationClicked, this, &QNotifications::notificationClicked);
+    Q_D(QNotifications);
+    d->engine = qt_notification_engine(engineName);
+    if (d->engine) {
+        d->engine->addNotificationOwner(this);
+        // Events about notifications are delivered by the engine to the
+        // QNotifications object that sent them, see setNotificationOwner()
+        connect(d->engine, &QPlatformNotificationEngine::capabilitiesChanged, this, &QNotifications::capabilitiesChanged);
+        connect(d->engine, &QPlatformNotificationEngine::availabilityChanged, this, &QNotifications::availabilityChanged);
+        connect(d->engine, &QPlatformNotificationEngine::circuitStateChanged, this, &QNotifications::circuitStateChanged);
+        connect(this, &QNotifications::notificationClosed, this, [d](uint notificationId) {
+            d->onNotificationClosed(notificationId);
+        });
+        connect(d->engine, &QPlatformNotificationEngine::serverIdentityChanged, this, [d](const QString &serverIdentity) {
+            d->onServerIdentityChanged(serverIdentity);
+        });
     }
 }
 
-QNotifications::~QNotifications() = default;
+QNotifications::~QNotifications()
+{
+    Q_D(QNotifications);
+    if (d->engine)
+        d->engine->removeNotificationOwner(this);
+}
 
 /*!
     Returns \c true if notifications are supported on the current platform;
@@ -108,26 +989,953 @@ QNotifications::~QNotifications() = default;
 */
 bool QNotifications::isSupported() const
 {
-    return m_engine && m_engine->isSupported();
+    Q_D(const QNotifications);
+    return d->engine && d->engine->isSupported();
 }
 
 /*!
-    Sends a notification with the given \a title, \a message, \a parameters, and \a actions.
+    \property QNotifications::available
+    \brief whether a notification server is there to show notifications.
 
-    This is the most complete form of sendNotification(), including all optional features.
+    On Linux, this is \c true while a process owns the
+    \c org.freedesktop.Notifications service on the session bus, or while the bus
+    can start one on demand. Both are asked asynchronously once the engine has
+    connected to the bus, and the owner of the service is watched afterwards, so
+    reading this property never blocks. Until the answers arrive, the server is
+    assumed to be available.
 
-    Returns the ID of the notification that was sent.
+    On other platforms, this is the same as isSupported().
 
-    \sa actionInvoked()
+    \sa isSupported(), prewarm()
 */
-uint QNotifications::sendNotification(const QString &title,
-                                     const QString &message,
-                                     const QVariantMap &parameters,
-                                     const QMap<QString, QString> &actions)
+bool QNotifications::isAvailable() const
 {
-    if (!m_engine)
-        return 0;
-    return m_engine->sendNotification(title, message, parameters, actions);
+    Q_D(const QNotifications);
+    return d->engine && d->engine->isAvailable();
+}
+
+/*!
+    Prepares the notification server in the background, so that the first
+    notification sent does not wait for it.
+
+    On Linux, this asks the session bus to start the notification server if it is
+    not running, then asks it for its information and capabilities. Without
+    it, the server is started by the first notification, which then waits for
+    the server to come up. Nothing blocks; call this right after constructing the
+    object to overlap the server's start-up with that of the application.
+
+    On other platforms, this does nothing.
+
+    \sa available
+*/
+void QNotifications::prewarm()
+{
+    Q_D(QNotifications);
+    if (d->engine)
+        d->engine->prewarm();
+}
+
+/*!
+    Returns the name of the notification engine used by this object, or an empty
+    string if no engine is available.
+
+    \sa availableEngines()
+*/
+QString QNotifications::engineName() const
+{
+    Q_D(const QNotifications);
+    return d->engine ? d->engine->objectName() : QString();
+}
+
+/*!
+    Returns the names of all notification engines that can be passed to the
+    QNotifications constructor.
+*/
+QStringList QNotifications::availableEngines()
+{
+    return qt_notification_engines();
+}
+
+Q_CONSTINIT static QBasicAtomicInteger<bool> engineThreadEnabled = Q_BASIC_ATOMIC_INITIALIZER(false);
+
+/*!
+    Sets whether engines that support it run on a dedicated thread to \a enabled.
+
+    The Linux engine then builds its D-Bus messages, including any image data, and
+    handles the replies on its own thread instead of the thread that sends the
+    notifications, which is usually the GUI thread. The setting is read when an
+    engine is created, so it must be made before the first QNotifications object
+    is constructed. The \c QT_NOTIFICATIONS_DBUS_THREAD environment variable, if
+    set, overrides it.
+
+    The default is \c false.
+
+    \sa isEngineThreadEnabled()
+*/
+void QNotifications::setEngineThreadEnabled(bool enabled)
+{
+    engineThreadEnabled.storeRelease(enabled);
+}
+
+/*!
+    Returns whether engines that support it run on a dedicated thread.
+
+    \sa setEngineThreadEnabled()
+*/
+bool QNotifications::isEngineThreadEnabled()
+{
+    bool overridden = false;
+    const int enabled = qEnvironmentVariableIntValue("QT_NOTIFICATIONS_DBUS_THREAD", &overridden);
+    if (overridden)
+        return enabled > 0;
+    return engineThreadEnabled.loadAcquire();
+}
+
+/*!
+    \property QNotifications::capabilities
+    \brief the optional features supported by the notification server.
+
+    On Linux, this is the list returned by the server's \c GetCapabilities method,
+    such as \c actions, \c body, \c body-markup and \c icon-static. The list is
+    fetched asynchronously once a server is running, cached, and fetched again
+    whenever another process takes over the notification service.
+
+    Features the server does not support are left out of the notifications sent to
+    it: actions are dropped without \c actions, images without \c icon-static or
+    \c icon-multi, and markup is reduced to plain text without \c body-markup.
+    Until the capabilities are known, everything is sent.
+
+    The list is empty while the capabilities are unknown, and for engines that do
+    not report them.
+*/
+QStringList QNotifications::capabilities() const
+{
+    Q_D(const QNotifications);
+    return d->engine ? d->engine->capabilities() : QStringList();
+}
+
+/*!
+    \property QNotifications::batchingEnabled
+    \brief whether asynchronous sends of the same event loop iteration are batched.
+
+    When enabled, sendNotificationAsync() does not contact the platform immediately.
+    Instead, all requests made before control returns to the event loop are handed
+    to the engine together, as if sendNotifications() had been called.
+
+    Synchronous sends made with sendNotification() are never batched.
+
+    The default is \c false.
+*/
+void QNotifications::setBatchingEnabled(bool enabled)
+{
+    Q_D(QNotifications);
+    if (d->batchingEnabled == enabled)
+        return;
+    d->batchingEnabled = enabled;
+    if (!enabled)
+        d->flushBatch();
+}
+
+bool QNotifications::isBatchingEnabled() const
+{
+    Q_D(const QNotifications);
+    return d->batchingEnabled;
+}
+
+/*!
+    \property QNotifications::maximumInFlight
+    \brief the maximum number of notifications sent with sendNotificationAsync()
+    that may wait for the platform at the same time.
+
+    When this is greater than zero, sendNotificationAsync() puts requests that
+    exceed the limit into a queue instead of sending them. The queue is ordered by
+    QNotificationRequest::urgency(), so that a critical notification overtakes a
+    flood of low-urgency ones, and is first in, first out within each urgency.
+    Whenever the platform answers a send, the next queued requests are sent; all
+    requests released at the same time are sent as one batch, as with
+    sendNotifications().
+
+    A queued request can be withdrawn by cancelling its future with
+    QFuture::cancel(); it is then skipped when its turn comes.
+
+    Other ways of sending notifications are neither queued nor counted against
+    the limit.
+
+    The default is \c 0, which sends every request immediately.
+
+    \sa queueDepth, backpressure()
+*/
+void QNotifications::setMaximumInFlight(int count)
+{
+    Q_D(QNotifications);
+    d->maximumInFlight = qMax(0, count);
+    if (d->engine) {
+        d->dispatchQueued();
+        d->onQueueDepthChanged();
+    }
+}
+
+int QNotifications::maximumInFlight() const
+{
+    Q_D(const QNotifications);
+    return d->maximumInFlight;
+}
+
+/*!
+    \property QNotifications::backpressureThreshold
+    \brief the queue depth at which backpressure() is signalled.
+
+    The default is \c 64.
+
+    \sa maximumInFlight
+*/
+void QNotifications::setBackpressureThreshold(int depth)
+{
+    Q_D(QNotifications);
+    d->backpressureThreshold = qMax(1, depth);
+}
+
+int QNotifications::backpressureThreshold() const
+{
+    Q_D(const QNotifications);
+    return d->backpressureThreshold;
+}
+
+/*!
+    \property QNotifications::queueDepth
+    \brief the number of requests waiting in the send queue.
+
+    Cancelled requests are counted until their turn comes.
+
+    \sa maximumInFlight
+*/
+int QNotifications::queueDepth() const
+{
+    Q_D(const QNotifications);
+    return int(d->queueDepth);
+}
+
+/*!
+    \property QNotifications::sendTimeout
+    \brief the default time in milliseconds the platform has to accept a notification.
+
+    A send that is not answered in time fails, and its ID is \c 0. On Linux, this
+    bounds how long sendNotification() can block when the notification server
+    hangs. QNotificationRequest::setSendTimeout() overrides it for a single
+    notification.
+
+    The timeout is a setting of the engine, shared by all QNotifications objects
+    that use it. The default is \c -1, which uses the default of the platform;
+    for D-Bus, that is 25 seconds.
+
+    \sa circuitState
+*/
+void QNotifications::setSendTimeout(int milliseconds)
+{
+    Q_D(QNotifications);
+    if (d->engine)
+        d->engine->setDefaultSendTimeout(milliseconds);
+}
+
+int QNotifications::sendTimeout() const
+{
+    Q_D(const QNotifications);
+    return d->engine ? d->engine->defaultSendTimeout() : -1;
+}
+
+/*!
+    \enum QNotifications::CircuitState
+
+    This enum describes whether the engine is sending notifications to the
+    notification server.
+
+    \value Closed
+        The server answers, and notifications are sent to it.
+    \value Open
+        Several sends in a row timed out or failed. Sends fail immediately,
+        without contacting the server, until a probe gets an answer.
+    \value HalfOpen
+        The engine is probing the server. Sends still fail immediately.
+*/
+
+/*!
+    \property QNotifications::circuitState
+    \brief the state of the engine's circuit breaker.
+
+    On Linux, the circuit breaker opens after three consecutive \c Notify calls
+    timed out or failed. While it is open, every send returns \c 0 at once
+    instead of waiting for a hung server, and postNotification() drops the
+    notification, which could only queue up in front of the server. The close
+    functions, which never wait, are still written to the bus. The engine
+    probes the server with \c GetServerInformation after one second, and after
+    twice as long each time the server does not answer, up to one minute. The
+    circuit closes when a probe or a late reply succeeds, or when another
+    process takes over the notification service.
+
+    Other engines are always \l{CircuitState}{Closed}.
+
+    \sa sendTimeout
+*/
+QNotifications::CircuitState QNotifications::circuitState() const
+{
+    Q_D(const QNotifications);
+    return d->engine ? d->engine->circuitState() : CircuitState::Closed;
+}
+
+/*!
+    Limits notifications of \a category to \a notificationsPerSecond on average,
+    allowing bursts of up to \a burst notifications.
+
+    Each category has a token bucket that holds up to \a burst tokens and is
+    refilled at \a notificationsPerSecond. Every notification sent takes a token.
+    A notification that finds the bucket empty is not sent; the send functions
+    return \c 0 for it. Instead, a summary notification saying how many
+    notifications were left out, with the title of the last of them as its
+    message, is sent at most once per second and updated in place while more are left out. Once the user
+    closes the summary, the next one starts counting from zero.
+
+    The limit for an empty \a category applies to every category without a limit
+    of its own, with a separate bucket for each category.
+
+    Updates sent with updateNotification() are not rate limited.
+
+    \sa clearRateLimit(), suppressedNotificationCount(), QNotificationRequest::setCategory()
+*/
+void QNotifications::setRateLimit(const QString &category, double notificationsPerSecond, int burst)
+{
+    Q_D(QNotifications);
+    if (notificationsPerSecond <= 0 || burst < 1) {
+        qWarning("QNotifications::setRateLimit: The rate and the burst must be positive");
+        return;
+    }
+    if (!d->summaryTimer) {
+        d->rateLimitClock.start();
+        d->summaryTimer = new QTimer(this);
+        d->summaryTimer->setSingleShot(true);
+        d->summaryTimer->setInterval(SummaryInterval);
+        connect(d->summaryTimer, &QTimer::timeout, this, [d] { d->sendSummaries(); });
+    }
+    d->rateLimits.insert(category, { notificationsPerSecond, burst });
+}
+
+/*!
+    Removes the rate limit of \a category.
+
+    \sa setRateLimit()
+*/
+void QNotifications::clearRateLimit(const QString &category)
+{
+    Q_D(QNotifications);
+    d->rateLimits.remove(category);
+}
+
+/*!
+    Returns the number of notifications that were not sent because of a rate limit.
+
+    \sa summarizedNotificationCount(), setRateLimit()
+*/
+quint64 QNotifications::suppressedNotificationCount() const
+{
+    Q_D(const QNotifications);
+    return d->suppressedCount;
+}
+
+/*!
+    Returns the number of suppressed notifications that have been reported by a
+    summary notification.
+
+    The difference to suppressedNotificationCount() is the number of suppressed
+    notifications waiting for the next summary.
+
+    \sa suppressedNotificationCount(), setRateLimit()
+*/
+quint64 QNotifications::summarizedNotificationCount() const
+{
+    Q_D(const QNotifications);
+    return d->summarizedCount;
+}
+
+/*!
+    \property QNotifications::groupThreshold
+    \brief the number of notifications of a group that are shown individually.
+
+    When more notifications with the same QNotificationRequest::group() than
+    this are shown, QNotifications closes them and sends a single summary
+    notification instead, such as "12 new notifications from #ops", with the
+    title of the latest notification as its message. Further notifications of
+    the group are not sent; the send functions return \c 0 for them, and the
+    summary is updated in place to count them. Once the user closes the
+    summary, notifications of the group are shown individually again.
+
+    The default is \c 0, which never collapses a group. Notifications sent with
+    postNotification() have no known ID, so they are not counted as shown, but
+    they are collapsed like any other notification while a group is.
+
+    \sa QNotificationRequest::setGroup()
+*/
+void QNotifications::setGroupThreshold(int count)
+{
+    Q_D(QNotifications);
+    count = qMax(0, count);
+    if (d->groupThreshold == count)
+        return;
+    d->groupThreshold = count;
+    if (count == 0) {
+        d->groups.clear();
+        d->notificationGroups.clear();
+        d->summaryIds.removeIf([](const auto &summary) {
+            return summary.value().first == QNotificationsPrivate::SummaryKind::Group;
+        });
+    }
+}
+
+int QNotifications::groupThreshold() const
+{
+    Q_D(const QNotifications);
+    return d->groupThreshold;
+}
+
+/*!
+    \enum QNotifications::DeduplicationMode
+
+    This enum describes what happens to a notification that repeats one sent
+    shortly before.
+
+    \value NoDeduplication
+        Every notification is sent. This is the default.
+    \value SuppressDuplicates
+        The repeated notification is not sent.
+    \value ReplaceDuplicates
+        The repeated notification is not sent; instead, the notification it
+        repeats is updated in place with the number of times it was sent in its
+        title, such as "Backup failed (3)".
+
+    \sa setDeduplication()
+*/
+
+/*!
+    Makes notifications that repeat one sent within the last
+    \a windowMilliseconds be handled according to \a mode.
+
+    A notification repeats another if it has the same title, message and
+    category. Each notification sent is remembered by a hash of these for
+    \a windowMilliseconds after it was first sent, and at most the 1024 most
+    recent notifications are remembered, so that checking a notification takes
+    constant time however many are sent. The send functions return \c 0 for a
+    notification that is not sent because it repeats another.
+
+    Only notifications that are shown are remembered: one that fails to send,
+    or that a rate limit or group summary holds back, does not make its repeats
+    duplicates, and closing a notification forgets it.
+
+    Deduplication is checked before rate limits, so repeated notifications do
+    not use up the rate limit of their category. Updates sent with
+    updateNotification() and notifications sent with submitNotification() are
+    never deduplicated. Since the ID of a notification sent with
+    postNotification() is not known, its repeats are dropped in either mode.
+
+    \sa deduplicationMode(), deduplicationWindow(), duplicateNotificationCount()
+*/
+void QNotifications::setDeduplication(DeduplicationMode mode, int windowMilliseconds)
+{
+    Q_D(QNotifications);
+    if (windowMilliseconds <= 0) {
+        qWarning("QNotifications::setDeduplication: The window must be positive");
+        return;
+    }
+    d->deduplicationMode = mode;
+    d->deduplicationWindow = windowMilliseconds;
+    if (mode == NoDeduplication) {
+        d->recent.clear();
+        d->recentOrder.clear();
+        d->recentIds.clear();
+    }
+}
+
+/*!
+    Returns how notifications that repeat a recent one are handled.
+
+    \sa setDeduplication()
+*/
+QNotifications::DeduplicationMode QNotifications::deduplicationMode() const
+{
+    Q_D(const QNotifications);
+    return d->deduplicationMode;
+}
+
+/*!
+    Returns the time in milliseconds for which a notification is remembered for
+    deduplication. The default is 5000.
+
+    \sa setDeduplication()
+*/
+int QNotifications::deduplicationWindow() const
+{
+    Q_D(const QNotifications);
+    return d->deduplicationWindow;
+}
+
+/*!
+    Returns the number of notifications that were not sent because they repeated
+    a recent one.
+
+    \sa setDeduplication()
+*/
+quint64 QNotifications::duplicateNotificationCount() const
+{
+    Q_D(const QNotifications);
+    return d->duplicateCount;
+}
+
+/*!
+    Returns a snapshot of the counters of the notification engine used by this object.
+
+    The counters are shared by all QNotifications objects that use the same engine.
+    They cover sends, updates and closed notifications, the notifications waiting
+    for the platform, the time the platform takes to reply, and, on Linux, the
+    bytes written to D-Bus and the signals dropped because they were about the
+    notifications of other applications.
+
+    Taking a snapshot only reads a few atomic integers, so it can be done
+    periodically in production, for example to report the counters to a
+    monitoring system.
+
+    \sa QNotificationsStatistics
+*/
+QNotificationsStatistics QNotifications::statistics() const
+{
+    Q_D(const QNotifications);
+    return d->engine ? d->engine->statistics() : QNotificationsStatistics();
+}
+
+/*!
+    Opens the notification journal at \a path, or at a file in the application's
+    local data directory if \a path is empty, and starts recording in it.
+
+    The journal records the ID, category, time and outcome of every notification
+    sent through this object, and when it was closed. It survives crashes and
+    restarts, so that the next run of the application knows which of its
+    notifications may still be shown: opening the journal replays it and makes
+    those available from outstandingNotifications(). They can then be withdrawn
+    with closeOutstandingNotifications(), or taken over with
+    adoptOutstandingNotifications() to receive their actionInvoked() and
+    notificationClosed() signals again.
+
+    The journal is a memory-mapped file of fixed-size records. Recording a
+    notification copies one record into the mapping; the operating system writes
+    it back to disk, and the journal asks it to at most once per second. Opening
+    the journal compacts it to the outstanding notifications, so it stays small
+    and replays in a few milliseconds.
+
+    A journal file can only be open in one QNotifications object at a time, in
+    this or any other process; a lock file next to it is held while it is open.
+    Returns \c true if the journal could be opened; otherwise returns \c false
+    and nothing is recorded. Call this once, before sending notifications.
+
+    \note Notification IDs are assigned by the platform. On Linux, they are only
+    meaningful as long as the notification server that assigned them keeps
+    running: a restarted server numbers its notifications from the start again,
+    and the IDs may then belong to other applications. The journal therefore
+    records which server assigned its IDs, by its unique bus name and the boot
+    ID, and discards the recorded notifications when another server is running,
+    or when the server changes while the journal is open.
+
+    \sa outstandingNotifications()
+*/
+bool QNotifications::openJournal(const QString &path)
+{
+    Q_D(QNotifications);
+    if (d->journal) {
+        qWarning("QNotifications::openJournal: The journal is already open");
+        return false;
+    }
+    auto journal = std::make_shared<QNotificationJournal>(path.isEmpty() ? QNotificationJournal::defaultPath()
+                                                                          : path);
+    if (!journal->open(d->engine ? d->engine->serverIdentity() : QString()))
+        return false;
+
+    d->outstanding.clear();
+    for (const QNotificationJournal::Entry &entry : journal->outstandingEntries())
+        d->outstanding.append(entry.notificationId);
+    d->journal = std::move(journal);
+    return true;
+}
+
+/*!
+    Returns the path of the open notification journal, or an empty string if
+    no journal is open.
+
+    \sa openJournal()
+*/
+QString QNotifications::journalPath() const
+{
+    Q_D(const QNotifications);
+    return d->journal ? d->journal->path() : QString();
+}
+
+/*!
+    Returns the IDs of the notifications that earlier runs of the application
+    sent and the journal has not seen closed, oldest first.
+
+    The list is read when the journal is opened and is emptied by
+    adoptOutstandingNotifications() and closeOutstandingNotifications().
+
+    \sa openJournal()
+*/
+QList<uint> QNotifications::outstandingNotifications() const
+{
+    Q_D(const QNotifications);
+    return d->outstanding;
+}
+
+/*!
+    Takes over the notifications returned by outstandingNotifications(), as if
+    they had been sent through this object.
+
+    Actions the user invokes on them are reported by actionInvoked() and
+    notificationClicked(), and closing them by notificationClosed(). They can
+    also be withdrawn with closeNotification() and closeAll().
+
+    \sa closeOutstandingNotifications()
+*/
+void QNotifications::adoptOutstandingNotifications()
+{
+    Q_D(QNotifications);
+    if (!d->engine || d->outstanding.isEmpty())
+        return;
+    const QList<uint> notificationIds = std::exchange(d->outstanding, {});
+    for (uint notificationId : notificationIds)
+        d->engine->setNotificationOwner(notificationId, this);
+    d->engine->adoptNotifications(notificationIds);
+}
+
+/*!
+    Withdraws the notifications returned by outstandingNotifications() and
+    records them as closed in the journal.
+
+    Only notifications assigned by the notification server that is running now
+    are outstanding, so this never withdraws a notification of another
+    application that reuses one of the recorded IDs.
+
+    \sa adoptOutstandingNotifications(), closeNotifications()
+*/
+void QNotifications::closeOutstandingNotifications()
+{
+    Q_D(QNotifications);
+    if (!d->engine || d->outstanding.isEmpty())
+        return;
+    const QList<uint> notificationIds = std::exchange(d->outstanding, {});
+    d->engine->closeNotifications(notificationIds);
+    for (uint notificationId : notificationIds)
+        d->journal->append(notificationId, QNotificationJournal::Closed);
+}
+
+/*!
+    Sends a notification with the given \a title, \a message, \a parameters, and \a actions.
+
+    The keys of \a parameters are described in \l{Qt Notifications Engines}.
+    Actions are added in the order of their keys.
+
+    Returns the ID of the notification that was sent.
+
+    \sa actionInvoked()
+*/
+uint QNotifications::sendNotification(const QString &title,
+                                     const QString &message,
+                                     const QVariantMap &parameters,
+                                     const QMap<QString, QString> &actions)
+{
+    return sendNotification(QNotificationsPrivate::requestFromParameters(title, message, parameters, actions));
+}
+
+/*!
+    \overload
+
+    Sends the notification described by \a request.
+
+    Returns the ID of the notification that was sent.
+*/
+uint QNotifications::sendNotification(const QNotificationRequest &request)
+{
+    Q_D(QNotifications);
+    Q_TRACE(QNotifications_sendNotification_entry, request.title());
+    if (!d->engine || !d->admit(request)) {
+        Q_TRACE(QNotifications_sendNotification_exit, 0u);
+        return 0;
+    }
+    const qint64 startedAt = d->engine->recordSendStarted();
+    const uint notificationId = d->engine->sendOwnedNotification(request, this);
+    d->engine->recordSendFinished(startedAt, notificationId != 0 ? 1 : 0, notificationId != 0 ? 0 : 1);
+    if (d->journal) {
+        d->journal->append(notificationId, notificationId != 0 ? QNotificationJournal::Sent : QNotificationJournal::Failed,
+                           request.category());
+    }
+    d->onNotificationPosted(request, notificationId, false, 0);
+    Q_TRACE(QNotifications_sendNotification_exit, notificationId);
+    return notificationId;
+}
+
+/*!
+    Sends a notification with the given \a title, \a message, \a parameters, and \a actions
+    without blocking the calling thread.
+
+    Returns a future that receives the ID of the notification once the platform
+    has assigned it. The result is \c 0 if the notification could not be sent.
+
+    Engines without a native asynchronous path send the notification immediately
+    and return a finished future.
+
+    \sa sendNotification(), postNotification(), batchingEnabled
+*/
+QFuture<uint> QNotifications::sendNotificationAsync(const QString &title,
+                                                    const QString &message,
+                                                    const QVariantMap &parameters,
+                                                    const QMap<QString, QString> &actions)
+{
+    return sendNotificationAsync(QNotificationsPrivate::requestFromParameters(title, message, parameters, actions));
+}
+
+/*!
+    \overload
+
+    Sends the notification described by \a request without blocking the calling thread.
+*/
+QFuture<uint> QNotifications::sendNotificationAsync(const QNotificationRequest &request)
+{
+    Q_D(QNotifications);
+    Q_TRACE_SCOPE(QNotifications_sendNotificationAsync, request.title());
+    if (!d->engine || !d->admit(request))
+        return QtFuture::makeReadyValueFuture(0u);
+    if (d->maximumInFlight > 0)
+        return d->enqueuePrioritized(request);
+    const qint64 startedAt = d->engine->recordSendStarted();
+    return d->trackNotification(d->batchingEnabled ? d->enqueueBatched(request)
+                                                   : d->engine->sendOwnedNotificationAsync(request, this),
+                                startedAt, request);
+}
+
+/*!
+    Sends a notification with the given \a title, \a message, \a parameters, and \a actions,
+    without asking for its ID.
+
+    This is the cheapest way to show a notification: on Linux, the request is sent
+    with the D-Bus \c NO_REPLY_EXPECTED flag, so no reply is ever routed back.
+    Since the ID is unknown, the notification cannot be correlated with later
+    \l actionInvoked(), \l notificationClicked() or \l notificationClosed() signals.
+
+    While the \l circuitState is not \l{CircuitState}{Closed}, the notification
+    is dropped.
+
+    \sa sendNotificationAsync()
+*/
+void QNotifications::postNotification(const QString &title,
+                                      const QString &message,
+                                      const QVariantMap &parameters,
+                                      const QMap<QString, QString> &actions)
+{
+    postNotification(QNotificationsPrivate::requestFromParameters(title, message, parameters, actions));
+}
+
+/*!
+    \overload
+
+    Sends the notification described by \a request, without asking for its ID.
+*/
+void QNotifications::postNotification(const QNotificationRequest &request)
+{
+    Q_D(QNotifications);
+    // Checked before admit(), so that a dropped notification does not count
+    // against rate limits or make its repeats duplicates
+    if (!d->engine || d->engine->circuitState() != CircuitState::Closed || !d->admit(request))
+        return;
+    if (d->engine->sendNotificationNoReply(request))
+        d->engine->recordPosted();
+}
+
+/*!
+    Sends all notifications described by \a requests in one batch.
+
+    Returns a future that receives the IDs of the notifications, in the order of
+    \a requests, once all of them have been assigned. An ID is \c 0 if the
+    corresponding notification could not be sent.
+
+    \sa sendNotificationAsync(), batchingEnabled
+*/
+QFuture<QList<uint>> QNotifications::sendNotifications(const QList<QNotificationRequest> &requests)
+{
+    Q_D(QNotifications);
+    if (!d->engine)
+        return QtFuture::makeReadyValueFuture(QList<uint>(requests.size(), 0u));
+
+    if (d->rateLimits.isEmpty() && d->deduplicationMode == NoDeduplication && d->groupThreshold == 0) {
+        const qint64 startedAt = d->engine->recordSendStarted(requests.size());
+        return d->trackNotifications(d->engine->sendOwnedNotifications(requests, this), startedAt, requests);
+    }
+
+    // Send only the admitted requests, leaving out duplicates and notifications
+    // over the rate limit, and put the IDs back into place
+    QList<QNotificationRequest> admitted;
+    QList<qsizetype> positions;
+    for (qsizetype i = 0; i < requests.size(); ++i) {
+        if (d->admit(requests.at(i))) {
+            admitted.append(requests.at(i));
+            positions.append(i);
+        }
+    }
+    const qsizetype count = requests.size();
+    const qint64 startedAt = d->engine->recordSendStarted(admitted.size());
+    return d->trackNotifications(d->engine->sendOwnedNotifications(admitted, this), startedAt, admitted)
+            .then([count, positions](const QList<uint> &sent) {
+        QList<uint> ids(count, 0u);
+        for (qsizetype i = 0; i < positions.size(); ++i)
+            ids[positions.at(i)] = sent.value(i);
+        return ids;
+    });
+}
+
+/*!
+    Sends the notification described by \a request from any thread.
+
+    Returns a future that receives the ID of the notification once the platform
+    has assigned it, or \c 0 if the notification could not be sent. Events about
+    the notification are delivered by this object, on its own thread.
+
+    \note This function is thread-safe.
+
+    The request is pushed onto a lock-free queue without taking any lock; only the
+    first submission after the queue has been drained posts an event to the
+    engine's thread. There, all requests submitted in the meantime are sent
+    together, as with sendNotifications().
+
+    Submitted notifications are neither batched with sendNotificationAsync()
+    calls nor subject to rate limits, which belong to the thread of this object.
+
+    \sa sendNotificationAsync()
+*/
+QFuture<uint> QNotifications::submitNotification(const QNotificationRequest &request)
+{
+    Q_D(QNotifications);
+    if (!d->engine)
+        return QtFuture::makeReadyValueFuture(0u);
+    QFuture<uint> future = d->engine->submitNotification(request, this);
+    if (!d->journal)
+        return future;
+    // The journal is thread-safe, and outlives this object if need be
+    return future.then(QtFuture::Launch::Sync, [journal = d->journal, category = request.category()](uint notificationId) {
+        journal->append(notificationId, notificationId != 0 ? QNotificationJournal::Sent : QNotificationJournal::Failed, category);
+        return notificationId;
+    });
+}
+
+/*!
+    Replaces the contents of the notification identified by \a notificationId with
+    the given \a title, \a message, \a parameters, and \a actions.
+
+    \sa sendNotification()
+*/
+QFuture<uint> QNotifications::updateNotification(uint notificationId,
+                                                 const QString &title,
+                                                 const QString &message,
+                                                 const QVariantMap &parameters,
+                                                 const QMap<QString, QString> &actions)
+{
+    return updateNotification(notificationId,
+                              QNotificationsPrivate::requestFromParameters(title, message, parameters, actions));
+}
+
+/*!
+    \overload
+
+    Replaces the contents of the notification identified by \a notificationId with
+    the notification described by \a request, without blocking the calling thread.
+
+    Returns a future that receives the ID of the updated notification. This is
+    usually \a notificationId, but the platform may assign a new ID if the
+    notification was closed in the meantime. The result is \c 0 if the
+    notification could not be sent.
+
+    On Linux, the update is sent as a \c Notify call with \c replaces_id set, and
+    updates of the same notification are coalesced: at most one of them is in flight
+    at any time, and of the updates made while it is, only the latest is sent once
+    the server has replied. The futures of the skipped updates receive the result
+    of that send. This lets frequently changing state, such as the progress of a
+    download, be reported on every change without flooding the server.
+
+    Engines that cannot replace notifications send \a request as a new notification.
+
+    \code
+    QNotificationRequest progress("Downloading", "0%");
+    const uint id = notifications.sendNotification(progress);
+    connect(reply, &QNetworkReply::downloadProgress, this, [&notifications, id, progress](qint64 received, qint64 total) mutable {
+        progress.setMessage(QStringLiteral("%1%").arg(received * 100 / qMax(total, 1)));
+        notifications.updateNotification(id, progress);
+    });
+    \endcode
+
+    \sa sendNotificationAsync()
+*/
+QFuture<uint> QNotifications::updateNotification(uint notificationId, const QNotificationRequest &request)
+{
+    Q_D(QNotifications);
+    if (!d->engine)
+        return QtFuture::makeReadyValueFuture(0u);
+    const qint64 startedAt = d->engine->recordSendStarted();
+    return d->trackNotification(d->engine->updateOwnedNotification(notificationId, request, this), startedAt,
+                                request, true, notificationId);
+}
+
+/*!
+    Withdraws the notification identified by \a notificationId.
+
+    The notification is removed from the screen and, where the platform keeps
+    one, from the notification history. Once the platform confirms it,
+    \l notificationClosed() is emitted with the \l Closed reason.
+
+    Engines that cannot withdraw notifications ignore the request.
+
+    \sa closeNotifications(), closeAll()
+*/
+void QNotifications::closeNotification(uint notificationId)
+{
+    Q_D(QNotifications);
+    if (!d->engine)
+        return;
+    d->engine->closeNotification(notificationId);
+}
+
+/*!
+    Withdraws all notifications identified by \a notificationIds.
+
+    On Linux, a \c CloseNotification call is written to the D-Bus connection for
+    every notification without waiting for any reply, so closing hundreds of
+    notifications costs little more than closing one.
+
+    \sa closeNotification(), closeAll()
+*/
+void QNotifications::closeNotifications(const QList<uint> &notificationIds)
+{
+    Q_D(QNotifications);
+    if (!d->engine || notificationIds.isEmpty())
+        return;
+    d->engine->closeNotifications(notificationIds);
+}
+
+/*!
+    Withdraws all notifications sent through this object that are still shown.
+
+    Notifications sent with postNotification() have no known ID and are not
+    withdrawn.
+
+    \sa closeNotifications()
+*/
+void QNotifications::closeAll()
+{
+    Q_D(QNotifications);
+    if (!d->engine)
+        return;
+    const QList<uint> notificationIds = d->engine->notificationsOwnedBy(this);
+    if (!notificationIds.isEmpty())
+        d->engine->closeNotifications(notificationIds);
 }
 
 QT_END_NAMESPACE
@@ -2,19 +2,33 @@
 #define QNOTIFICATIONS_H
 
 #include <QtNotifications/qnotifications_global.h>
+#include <QtNotifications/qnotificationrequest.h>
+#include <QtNotifications/qnotificationsstatistics.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qfuture.h>
 
 QT_BEGIN_NAMESPACE
 
-class QPlatformNotificationEngine;
+class QNotificationsPrivate;
 
 class Q_NOTIFICATIONS_EXPORT QNotifications : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(bool batchingEnabled READ isBatchingEnabled WRITE setBatchingEnabled)
+    Q_PROPERTY(QStringList capabilities READ capabilities NOTIFY capabilitiesChanged)
+    Q_PROPERTY(bool available READ isAvailable NOTIFY availabilityChanged)
+    Q_PROPERTY(int maximumInFlight READ maximumInFlight WRITE setMaximumInFlight)
+    Q_PROPERTY(int backpressureThreshold READ backpressureThreshold WRITE setBackpressureThreshold)
+    Q_PROPERTY(int queueDepth READ queueDepth NOTIFY queueDepthChanged)
+    Q_PROPERTY(int sendTimeout READ sendTimeout WRITE setSendTimeout)
+    Q_PROPERTY(CircuitState circuitState READ circuitState NOTIFY circuitStateChanged)
+    Q_PROPERTY(int groupThreshold READ groupThreshold WRITE setGroupThreshold)
 
 public:
     explicit QNotifications(QObject *parent = nullptr);
+    explicit QNotifications(const QString &engineName, QObject *parent = nullptr);
     ~QNotifications();
 
     enum ClosedReason {
@@ -25,21 +39,105 @@ public:
     };
     Q_ENUM(ClosedReason)
 
+    enum DeduplicationMode {
+        NoDeduplication,
+        SuppressDuplicates,
+        ReplaceDuplicates
+    };
+    Q_ENUM(DeduplicationMode)
+
+    enum class CircuitState {
+        Closed,
+        Open,
+        HalfOpen
+    };
+    Q_ENUM(CircuitState)
+
     bool isSupported() const;
+    bool isAvailable() const;
+    void prewarm();
+    QString engineName() const;
+    static QStringList availableEngines();
+    static void setEngineThreadEnabled(bool enabled);
+    static bool isEngineThreadEnabled();
+    QStringList capabilities() const;
+
+    void setBatchingEnabled(bool enabled);
+    bool isBatchingEnabled() const;
+
+    void setMaximumInFlight(int count);
+    int maximumInFlight() const;
+    void setBackpressureThreshold(int depth);
+    int backpressureThreshold() const;
+    int queueDepth() const;
+
+    void setSendTimeout(int milliseconds);
+    int sendTimeout() const;
+    CircuitState circuitState() const;
+
+    void setRateLimit(const QString &category, double notificationsPerSecond, int burst);
+    void clearRateLimit(const QString &category);
+    quint64 suppressedNotificationCount() const;
+    quint64 summarizedNotificationCount() const;
+
+    void setDeduplication(DeduplicationMode mode, int windowMilliseconds = 5000);
+    DeduplicationMode deduplicationMode() const;
+    int deduplicationWindow() const;
+    quint64 duplicateNotificationCount() const;
+
+    void setGroupThreshold(int count);
+    int groupThreshold() const;
+
+    QNotificationsStatistics statistics() const;
+
+    bool openJournal(const QString &path = QString());
+    QString journalPath() const;
+    QList<uint> outstandingNotifications() const;
+    void adoptOutstandingNotifications();
+    void closeOutstandingNotifications();
 
     uint sendNotification(const QString &title,
                          const QString &message,
                          const QVariantMap &parameters = {},
                          const QMap<QString, QString> &actions = {});
+    uint sendNotification(const QNotificationRequest &request);
+    QFuture<uint> sendNotificationAsync(const QString &title,
+                                        const QString &message,
+                                        const QVariantMap &parameters = {},
+                                        const QMap<QString, QString> &actions = {});
+    QFuture<uint> sendNotificationAsync(const QNotificationRequest &request);
+    void postNotification(const QString &title,
+                          const QString &message,
+                          const QVariantMap &parameters = {},
+                          const QMap<QString, QString> &actions = {});
+    void postNotification(const QNotificationRequest &request);
+    QFuture<QList<uint>> sendNotifications(const QList<QNotificationRequest> &requests);
+    QFuture<uint> submitNotification(const QNotificationRequest &request);
+    QFuture<uint> updateNotification(uint notificationId,
+                                     const QString &title,
+                                     const QString &message,
+                                     const QVariantMap &parameters = {},
+                                     const QMap<QString, QString> &actions = {});
+    QFuture<uint> updateNotification(uint notificationId, const QNotificationRequest &request);
+
+    void closeNotification(uint notificationId);
+    void closeNotifications(const QList<uint> &notificationIds);
+    void closeAll();
 
 Q_SIGNALS:
     void actionInvoked(uint notificationId, const QString &actionKey);
     void notificationClosed(uint notificationId, ClosedReason reason);
     void notificationClicked(uint notificationId);
+    void notificationPosted(uint notificationId, const QNotificationRequest &request, uint replacedId);
+    void capabilitiesChanged();
+    void availabilityChanged(bool available);
+    void queueDepthChanged(int depth);
+    void backpressure(bool active);
+    void circuitStateChanged(QNotifications::CircuitState state);
 
 private:
+    Q_DECLARE_PRIVATE(QNotifications)
     Q_DISABLE_COPY(QNotifications)
-    QPlatformNotificationEngine *m_engine;
 };
 
 QT_END_NAMESPACE
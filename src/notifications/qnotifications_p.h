@@ -0,0 +1,186 @@
+#ifndef QNOTIFICATIONS_P_H
+#define QNOTIFICATIONS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNotifications/qnotifications.h>
+#include <QtCore/private/qobject_p.h>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPromise>
+
+#include <array>
+#include <memory>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+class QNotificationJournal;
+class QPlatformNotificationEngine;
+class QTimer;
+
+class QNotificationsPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QNotifications)
+public:
+    struct PendingSend
+    {
+        QNotificationRequest request;
+        std::shared_ptr<QPromise<uint>> promise;
+    };
+
+    struct RateLimit
+    {
+        double rate = 0;
+        int burst = 0;
+    };
+
+    enum class SummaryKind { Category, Group };
+
+    // A summary notification, sent once and then updated in place
+    struct Summary
+    {
+        uint notificationId = 0;
+        // A send or update of the summary is in flight
+        bool sending = false;
+        // The summary changed while it was in flight
+        bool stale = false;
+    };
+
+    // Token bucket and summary state of one category
+    struct CategoryState
+    {
+        double tokens = 0;
+        qint64 lastRefill = -1;
+        // Suppressed notifications that no summary has reported yet
+        quint64 unreported = 0;
+        // Suppressed notifications reported by the summary shown now
+        quint64 reported = 0;
+        // What the summary shows of the last suppressed notification
+        QString lastTitle;
+        QString lastIcon;
+        QNotificationRequest::Urgency lastUrgency = QNotificationRequest::Normal;
+        Summary summary;
+    };
+
+    // A notification sent within the deduplication window
+    struct RecentNotification
+    {
+        QNotificationRequest request;
+        qint64 seenAt = 0;
+        uint notificationId = 0;
+        int count = 1;
+        bool bumpPending = false;
+    };
+
+    // Notifications of one group, either shown one by one or collapsed into a summary
+    struct GroupState
+    {
+        // Notifications shown individually, oldest first
+        QList<uint> live;
+        // Notifications counted by the summary
+        quint64 collapsed = 0;
+        QNotificationRequest last;
+        Summary summary;
+    };
+
+    static QNotificationRequest requestFromParameters(const QString &title,
+                                                      const QString &message,
+                                                      const QVariantMap &parameters,
+                                                      const QMap<QString, QString> &actions);
+
+    QFuture<uint> enqueueBatched(const QNotificationRequest &request);
+    void flushBatch();
+
+    QFuture<uint> enqueuePrioritized(const QNotificationRequest &request);
+    void dispatchQueued();
+    void onQueueDepthChanged();
+
+    bool admit(const QNotificationRequest &request);
+    void pruneCategories(qint64 now);
+    void sendSummaries();
+    Summary *findSummary(SummaryKind kind, const QString &key);
+    void showSummary(SummaryKind kind, const QString &key, const QNotificationRequest &request);
+    void onNotificationClosed(uint notificationId);
+    void onServerIdentityChanged(const QString &serverIdentity);
+
+    static size_t deduplicationKey(const QNotificationRequest &request);
+    bool isDuplicate(const QNotificationRequest &request);
+    void forgetRecent(const QNotificationRequest &request);
+    void expireRecent(qint64 now);
+    void bumpDuplicate(size_t key, RecentNotification &entry);
+    bool isPostedSignalConnected() const;
+    void onNotificationPosted(const QNotificationRequest &request, uint notificationId, bool update,
+                              uint replacedId);
+    void onNotificationSent(const QNotificationRequest &request, uint notificationId);
+
+    bool collapseIntoGroup(const QNotificationRequest &request);
+    void addToGroup(const QNotificationRequest &request, uint notificationId);
+    void sendGroupSummary(const QString &group);
+
+    QFuture<uint> trackNotification(QFuture<uint> future, qint64 startedAt,
+                                    const QNotificationRequest &request, bool update = false,
+                                    uint replacedId = 0);
+    QFuture<QList<uint>> trackNotifications(QFuture<QList<uint>> future, qint64 startedAt,
+                                            const QList<QNotificationRequest> &requests);
+
+    QPlatformNotificationEngine *engine = nullptr;
+    bool batchingEnabled = false;
+    QList<PendingSend> batch;
+
+    // Sends waiting for an in-flight slot, one queue per urgency from Low to
+    // Critical; each queue is first in, first out
+    std::array<QList<PendingSend>, 3> sendQueues;
+    qsizetype queueDepth = 0;
+    qsizetype reportedQueueDepth = 0;
+    int maximumInFlight = 0;
+    int inFlight = 0;
+    int backpressureThreshold = 64;
+    bool backpressureActive = false;
+
+    QHash<QString, RateLimit> rateLimits;
+    // Only categories with a rate limit have a state
+    QHash<QString, CategoryState> categories;
+    // Number of category states at which idle ones are pruned next
+    qsizetype categoryPruneSize = 0;
+    QElapsedTimer rateLimitClock;
+    QTimer *summaryTimer = nullptr;
+    quint64 suppressedCount = 0;
+    quint64 summarizedCount = 0;
+
+    QNotifications::DeduplicationMode deduplicationMode = QNotifications::NoDeduplication;
+    int deduplicationWindow = 5000;
+    QElapsedTimer deduplicationClock;
+    QHash<size_t, RecentNotification> recent;
+    // Keys and times of the remembered notifications, oldest first
+    QList<std::pair<size_t, qint64>> recentOrder;
+    // Key of every remembered notification that has an ID
+    QHash<uint, size_t> recentIds;
+    quint64 duplicateCount = 0;
+
+    int groupThreshold = 0;
+    QHash<QString, GroupState> groups;
+    // Group of every notification shown individually
+    QHash<uint, QString> notificationGroups;
+    // Category or group of every summary shown
+    QHash<uint, std::pair<SummaryKind, QString>> summaryIds;
+
+    // Shared with the continuations of sends, which may complete on other threads
+    std::shared_ptr<QNotificationJournal> journal;
+    // Notifications of earlier runs that were neither adopted nor closed yet
+    QList<uint> outstanding;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONS_P_H
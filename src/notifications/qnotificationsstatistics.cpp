@@ -0,0 +1,183 @@
+#include "qnotificationsstatistics.h"
+#include "qnotificationsstatistics_p.h"
+
+QT_BEGIN_NAMESPACE
+
+QT_DEFINE_QSDP_SPECIALIZATION_DTOR(QNotificationsStatisticsPrivate)
+
+/*!
+    \class QNotificationsStatistics
+    \inmodule QtNotifications
+    \brief The QNotificationsStatistics class is a snapshot of the counters of a notification engine.
+
+    QNotifications::statistics() returns the counters of the engine used by a
+    QNotifications object. The counters cover all QNotifications objects that
+    use the same engine, since the process started. They are atomic integers
+    updated as notifications pass through the engine, so keeping them costs a
+    few atomic additions per notification and they are always enabled.
+
+    \code
+    const QNotificationsStatistics statistics = notifications.statistics();
+    qInfo() << statistics.engineName() << statistics.sentCount() << "sent,"
+            << statistics.failedCount() << "failed," << statistics.inFlightCount() << "in flight";
+    \endcode
+
+    The counters are read one after the other, so a snapshot taken while other
+    threads send notifications is not necessarily consistent across counters.
+
+    \sa QNotifications::statistics()
+*/
+
+/*!
+    Constructs an empty snapshot in which all counters are zero.
+*/
+QNotificationsStatistics::QNotificationsStatistics()
+    : d(new QNotificationsStatisticsPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QNotificationsStatistics::QNotificationsStatistics(const QNotificationsStatistics &other) = default;
+
+/*!
+    \fn QNotificationsStatistics::QNotificationsStatistics(QNotificationsStatistics &&other)
+
+    Move-constructs a snapshot from \a other.
+*/
+
+/*!
+    Assigns \a other to this snapshot.
+*/
+QNotificationsStatistics &QNotificationsStatistics::operator=(const QNotificationsStatistics &other) = default;
+
+/*!
+    \fn QNotificationsStatistics &QNotificationsStatistics::operator=(QNotificationsStatistics &&other)
+
+    Move-assigns \a other to this snapshot.
+*/
+
+/*!
+    Destroys the snapshot.
+*/
+QNotificationsStatistics::~QNotificationsStatistics() = default;
+
+/*!
+    \fn void QNotificationsStatistics::swap(QNotificationsStatistics &other)
+
+    Swaps this snapshot with \a other.
+*/
+
+/*!
+    \property QNotificationsStatistics::engineName
+    \brief the name of the engine the counters belong to.
+*/
+QString QNotificationsStatistics::engineName() const
+{
+    return d->engineName;
+}
+
+/*!
+    \property QNotificationsStatistics::sentCount
+    \brief the number of notifications the platform has accepted.
+
+    Notifications sent with QNotifications::postNotification() are counted when
+    they are handed to the platform, since no reply tells whether they arrived.
+*/
+quint64 QNotificationsStatistics::sentCount() const
+{
+    return d->sent;
+}
+
+/*!
+    \property QNotificationsStatistics::failedCount
+    \brief the number of notifications and updates that could not be sent.
+
+    Notifications left out by a rate limit are not counted.
+*/
+quint64 QNotificationsStatistics::failedCount() const
+{
+    return d->failed;
+}
+
+/*!
+    \property QNotificationsStatistics::updatedCount
+    \brief the number of notifications updated with QNotifications::updateNotification().
+
+    Updates coalesced into a later one are counted too.
+*/
+quint64 QNotificationsStatistics::updatedCount() const
+{
+    return d->updated;
+}
+
+/*!
+    \property QNotificationsStatistics::closedCount
+    \brief the number of notifications reported as closed, for any reason.
+*/
+quint64 QNotificationsStatistics::closedCount() const
+{
+    return d->closed;
+}
+
+/*!
+    \property QNotificationsStatistics::droppedSignalCount
+    \brief the number of signals about notifications of other applications that were dropped.
+
+    On Linux, the notification server broadcasts its signals to every application
+    listening; this counts those the engine received but ignored.
+*/
+quint64 QNotificationsStatistics::droppedSignalCount() const
+{
+    return d->droppedSignals;
+}
+
+/*!
+    \property QNotificationsStatistics::inFlightCount
+    \brief the number of sends and updates waiting for the platform's reply.
+*/
+qint64 QNotificationsStatistics::inFlightCount() const
+{
+    return d->inFlight;
+}
+
+/*!
+    \property QNotificationsStatistics::bytesMarshalled
+    \brief the approximate number of bytes of notification data written to the platform.
+
+    On Linux, this is the size of the arguments of the \c Notify calls, counting
+    text as one byte per character. Other engines do not report it.
+*/
+quint64 QNotificationsStatistics::bytesMarshalled() const
+{
+    return d->bytesMarshalled;
+}
+
+/*!
+    \property QNotificationsStatistics::latencyHistogram
+    \brief the distribution of the time between sending a notification and the platform's reply.
+
+    Each entry counts the sends and updates whose latency fell into one bucket.
+    The buckets are bounded by latencyBucketBounds(): entry \c i counts latencies
+    of less than bound \c i and at least bound \c{i - 1}. The last entry counts
+    latencies of at least the last bound.
+
+    For engines that send synchronously, the latency is the time the send took.
+*/
+QList<quint64> QNotificationsStatistics::latencyHistogram() const
+{
+    return d->latencyHistogram;
+}
+
+/*!
+    Returns the upper bounds of the buckets of latencyHistogram(), in microseconds.
+*/
+QList<qint64> QNotificationsStatistics::latencyBucketBounds()
+{
+    return QList<qint64>(QNotificationLatencyBucketBounds.cbegin(), QNotificationLatencyBucketBounds.cend());
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qnotificationsstatistics.cpp"
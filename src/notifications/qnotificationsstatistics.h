@@ -0,0 +1,60 @@
+#ifndef QNOTIFICATIONSSTATISTICS_H
+#define QNOTIFICATIONSSTATISTICS_H
+
+#include <QtNotifications/qnotifications_global.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobjectdefs.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+class QPlatformNotificationEngine;
+class QNotificationsStatisticsPrivate;
+QT_DECLARE_QSDP_SPECIALIZATION_DTOR_WITH_EXPORT(QNotificationsStatisticsPrivate, Q_NOTIFICATIONS_EXPORT)
+
+class Q_NOTIFICATIONS_EXPORT QNotificationsStatistics
+{
+    Q_GADGET
+    Q_PROPERTY(QString engineName READ engineName CONSTANT)
+    Q_PROPERTY(quint64 sentCount READ sentCount CONSTANT)
+    Q_PROPERTY(quint64 failedCount READ failedCount CONSTANT)
+    Q_PROPERTY(quint64 updatedCount READ updatedCount CONSTANT)
+    Q_PROPERTY(quint64 closedCount READ closedCount CONSTANT)
+    Q_PROPERTY(quint64 droppedSignalCount READ droppedSignalCount CONSTANT)
+    Q_PROPERTY(qint64 inFlightCount READ inFlightCount CONSTANT)
+    Q_PROPERTY(quint64 bytesMarshalled READ bytesMarshalled CONSTANT)
+    Q_PROPERTY(QList<quint64> latencyHistogram READ latencyHistogram CONSTANT)
+
+public:
+    QNotificationsStatistics();
+    QNotificationsStatistics(const QNotificationsStatistics &other);
+    QNotificationsStatistics(QNotificationsStatistics &&other) noexcept = default;
+    QNotificationsStatistics &operator=(const QNotificationsStatistics &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QNotificationsStatistics)
+    ~QNotificationsStatistics();
+
+    void swap(QNotificationsStatistics &other) noexcept { d.swap(other.d); }
+
+    QString engineName() const;
+    quint64 sentCount() const;
+    quint64 failedCount() const;
+    quint64 updatedCount() const;
+    quint64 closedCount() const;
+    quint64 droppedSignalCount() const;
+    qint64 inFlightCount() const;
+    quint64 bytesMarshalled() const;
+
+    QList<quint64> latencyHistogram() const;
+    static QList<qint64> latencyBucketBounds();
+
+private:
+    friend class QPlatformNotificationEngine;
+    QSharedDataPointer<QNotificationsStatisticsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QNotificationsStatistics)
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONSSTATISTICS_H
@@ -0,0 +1,43 @@
+#ifndef QNOTIFICATIONSSTATISTICS_P_H
+#define QNOTIFICATIONSSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNotifications/qnotificationsstatistics.h>
+
+#include <array>
+
+QT_BEGIN_NAMESPACE
+
+// Upper bounds, in microseconds, of all latency buckets but the last, which is open
+inline constexpr std::array<qint64, 12> QNotificationLatencyBucketBounds = {
+    250, 500, 1000, 2000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+};
+inline constexpr qsizetype QNotificationLatencyBucketCount = QNotificationLatencyBucketBounds.size() + 1;
+
+class QNotificationsStatisticsPrivate : public QSharedData
+{
+public:
+    QString engineName;
+    quint64 sent = 0;
+    quint64 failed = 0;
+    quint64 updated = 0;
+    quint64 closed = 0;
+    quint64 droppedSignals = 0;
+    qint64 inFlight = 0;
+    quint64 bytesMarshalled = 0;
+    QList<quint64> latencyHistogram = QList<quint64>(QNotificationLatencyBucketCount, 0);
+};
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONSSTATISTICS_P_H
@@ -0,0 +1,96 @@
+#ifndef QNOTIFICATIONSUBMISSIONQUEUE_P_H
+#define QNOTIFICATIONSUBMISSIONQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNotifications/qnotifications.h>
+#include <QtNotifications/qnotificationrequest.h>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QPromise>
+
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+struct QNotificationSubmission
+{
+    QNotificationRequest request;
+    QNotifications *owner = nullptr;
+    std::shared_ptr<QPromise<uint>> promise;
+};
+
+// Unbounded multi-producer, single-consumer queue of submitted notifications.
+// Producers never block each other: pushing is one atomic exchange on the head
+// followed by linking the previous node. Only the engine's thread pops.
+class QNotificationSubmissionQueue
+{
+public:
+    QNotificationSubmissionQueue()
+        : m_tail(new Node)
+    {
+        m_head.storeRelaxed(m_tail);
+    }
+
+    ~QNotificationSubmissionQueue()
+    {
+        while (pop()) {
+        }
+        delete m_tail;
+    }
+
+    Q_DISABLE_COPY_MOVE(QNotificationSubmissionQueue)
+
+    // Safe to call from any thread
+    void push(QNotificationSubmission submission)
+    {
+        Node *node = new Node;
+        node->submission = std::move(submission);
+        Node *previous = m_head.fetchAndStoreAcqRel(node);
+        previous->next.storeRelease(node);
+    }
+
+    // Consumer only. Returns nothing when the queue is empty, or when the
+    // next producer has not linked its node yet; see isEmpty()
+    std::optional<QNotificationSubmission> pop()
+    {
+        Node *tail = m_tail;
+        Node *next = tail->next.loadAcquire();
+        if (!next)
+            return std::nullopt;
+        // The popped node becomes the new sentinel
+        std::optional<QNotificationSubmission> submission = std::move(next->submission);
+        m_tail = next;
+        delete tail;
+        return submission;
+    }
+
+    // Consumer only. Returns false while a push is still in progress
+    bool isEmpty() const
+    {
+        return m_head.loadAcquire() == m_tail;
+    }
+
+private:
+    struct Node
+    {
+        QAtomicPointer<Node> next;
+        QNotificationSubmission submission;
+    };
+
+    QAtomicPointer<Node> m_head;
+    Node *m_tail;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNOTIFICATIONSUBMISSIONQUEUE_P_H
@@ -1,24 +1,534 @@
 #include "qplatformnotificationengine.h"
+#include "qplatformnotificationengine_loopback_p.h"
+#include "qnotificationsubmissionqueue_p.h"
+#include "qnotificationsstatistics_p.h"
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+#include <algorithm>
+#include <chrono>
 
 QT_BEGIN_NAMESPACE
 
-QPlatformNotificationEngine *qt_notification_engine()
+QPlatformNotificationEngine::QPlatformNotificationEngine(QObject *parent)
+    : QObject(parent)
+    , m_submissions(std::make_unique<QNotificationSubmissionQueue>())
+{
+    // Engines emit their events without knowing who sent the notification;
+    // each event is forwarded to the owner only, on the owner's thread
+    connect(this, &QPlatformNotificationEngine::actionInvoked, this, [this](uint notificationId, const QString &actionKey) {
+        if (QNotifications *owner = notificationOwner(notificationId)) {
+            invokeOnOwner(owner, [owner, notificationId, actionKey] {
+                emit owner->actionInvoked(notificationId, actionKey);
+            });
+        }
+    });
+    connect(this, &QPlatformNotificationEngine::notificationClicked, this, [this](uint notificationId) {
+        if (QNotifications *owner = notificationOwner(notificationId)) {
+            invokeOnOwner(owner, [owner, notificationId] {
+                emit owner->notificationClicked(notificationId);
+            });
+        }
+    });
+    connect(this, &QPlatformNotificationEngine::notificationClosed, this, [this](uint notificationId, QNotifications::ClosedReason reason) {
+        m_closedCount.fetchAndAddRelaxed(1);
+        if (QNotifications *owner = notificationOwner(notificationId, true)) {
+            invokeOnOwner(owner, [owner, notificationId, reason] {
+                emit owner->notificationClosed(notificationId, reason);
+            });
+        }
+    });
+}
+
+QPlatformNotificationEngine::~QPlatformNotificationEngine()
+{
+    // Submissions that were never sent still have to finish their futures
+    while (std::optional<QNotificationSubmission> submission = m_submissions->pop()) {
+        submission->promise->addResult(0u);
+        submission->promise->finish();
+    }
+}
+
+QFuture<uint> QPlatformNotificationEngine::submitNotification(const QNotificationRequest &request,
+                                                              QNotifications *owner)
+{
+    auto promise = std::make_shared<QPromise<uint>>();
+    QFuture<uint> future = promise->future();
+    promise->start();
+    m_submissions->push({ request, owner, std::move(promise) });
+
+    // Only the producer that finds no drain pending posts one, so a burst of
+    // submissions costs a single event for the engine's thread
+    if (!m_drainScheduled.fetchAndStoreAcquire(true))
+        QMetaObject::invokeMethod(this, &QPlatformNotificationEngine::drainSubmissions, Qt::QueuedConnection);
+    return future;
+}
+
+void QPlatformNotificationEngine::drainSubmissions()
+{
+    // Cleared before popping: a submission pushed from now on either is popped
+    // below or schedules the next drain
+    m_drainScheduled.storeRelease(false);
+
+    QList<QNotificationSubmission> submissions;
+    QList<QNotificationRequest> requests;
+    while (std::optional<QNotificationSubmission> submission = m_submissions->pop()) {
+        requests.append(submission->request);
+        submissions.append(std::move(*submission));
+    }
+    // A producer is between publishing its node and linking it; come back for it
+    if (!m_submissions->isEmpty() && !m_drainScheduled.fetchAndStoreAcquire(true))
+        QMetaObject::invokeMethod(this, &QPlatformNotificationEngine::drainSubmissions, Qt::QueuedConnection);
+    if (submissions.isEmpty())
+        return;
+
+    const qint64 startedAt = recordSendStarted(submissions.size());
+    sendNotifications(requests).then(QtFuture::Launch::Sync, [this, submissions, startedAt](const QList<uint> &notificationIds) {
+        const qsizetype sent = std::count_if(notificationIds.cbegin(), notificationIds.cend(),
+                                             [](uint notificationId) { return notificationId != 0; });
+        recordSendFinished(startedAt, sent, submissions.size() - sent);
+        for (qsizetype i = 0; i < submissions.size(); ++i) {
+            const QNotificationSubmission &submission = submissions.at(i);
+            const uint notificationId = notificationIds.value(i);
+            if (submission.owner)
+                setNotificationOwner(notificationId, submission.owner);
+            submission.promise->addResult(notificationId);
+            submission.promise->finish();
+        }
+    }).onCanceled([this, submissions, startedAt] {
+        recordSendFinished(startedAt, 0, submissions.size());
+        for (const QNotificationSubmission &submission : submissions) {
+            submission.promise->addResult(0u);
+            submission.promise->finish();
+        }
+    });
+}
+
+static qint64 statisticsClock()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QNotificationsStatistics QPlatformNotificationEngine::statistics() const
+{
+    static_assert(LatencyBucketCount == QNotificationLatencyBucketCount);
+
+    QNotificationsStatistics statistics;
+    QNotificationsStatisticsPrivate *d = statistics.d.data();
+    d->engineName = objectName();
+    d->sent = m_sentCount.loadRelaxed();
+    d->failed = m_failedCount.loadRelaxed();
+    d->updated = m_updatedCount.loadRelaxed();
+    d->closed = m_closedCount.loadRelaxed();
+    d->droppedSignals = m_droppedSignalCount.loadRelaxed();
+    d->inFlight = m_inFlightCount.loadRelaxed();
+    d->bytesMarshalled = m_bytesMarshalled.loadRelaxed();
+    for (qsizetype i = 0; i < LatencyBucketCount; ++i)
+        d->latencyHistogram[i] = m_latencyHistogram[i].loadRelaxed();
+    return statistics;
+}
+
+// Returns the time the send started, to be passed on to recordSendFinished()
+// or recordUpdateFinished()
+qint64 QPlatformNotificationEngine::recordSendStarted(qsizetype count)
+{
+    m_inFlightCount.fetchAndAddRelaxed(count);
+    return statisticsClock();
+}
+
+void QPlatformNotificationEngine::recordReplies(qint64 startedAt, qsizetype count)
+{
+    const qint64 latency = statisticsClock() - startedAt;
+    const auto bucket = std::upper_bound(QNotificationLatencyBucketBounds.cbegin(),
+                                         QNotificationLatencyBucketBounds.cend(), latency);
+    // All notifications of a batch are answered at about the same time
+    m_latencyHistogram[bucket - QNotificationLatencyBucketBounds.cbegin()].fetchAndAddRelaxed(count);
+    m_inFlightCount.fetchAndSubRelaxed(count);
+}
+
+void QPlatformNotificationEngine::recordSendFinished(qint64 startedAt, qsizetype sent, qsizetype failed)
+{
+    recordReplies(startedAt, sent + failed);
+    m_sentCount.fetchAndAddRelaxed(sent);
+    m_failedCount.fetchAndAddRelaxed(failed);
+}
+
+void QPlatformNotificationEngine::recordUpdateFinished(qint64 startedAt, bool succeeded)
+{
+    recordReplies(startedAt, 1);
+    if (succeeded)
+        m_updatedCount.fetchAndAddRelaxed(1);
+    else
+        m_failedCount.fetchAndAddRelaxed(1);
+}
+
+void QPlatformNotificationEngine::recordPosted()
+{
+    m_sentCount.fetchAndAddRelaxed(1);
+}
+
+void QPlatformNotificationEngine::recordDroppedSignal()
+{
+    m_droppedSignalCount.fetchAndAddRelaxed(1);
+}
+
+void QPlatformNotificationEngine::recordBytesMarshalled(qint64 bytes)
+{
+    m_bytesMarshalled.fetchAndAddRelaxed(bytes);
+}
+
+// Engines that never report a notification as closed would let the owners
+// grow without bound
+static constexpr qsizetype MaximumNotificationOwners = 4096;
+
+/*
+    Registers \a owner, a QNotifications object that was just constructed, as
+    one that events can be delivered to. It is unregistered by
+    removeNotificationOwner() when it is destroyed.
+*/
+void QPlatformNotificationEngine::addNotificationOwner(QNotifications *owner)
+{
+    QMutexLocker locker(&m_ownersMutex);
+    m_liveOwners.insert(owner);
+}
+
+/*
+    Makes \a owner the receiver of the events about \a notificationId. An
+    update shown under a new ID passes the ID it replaced as \a replacedId,
+    whose notification is gone.
+*/
+void QPlatformNotificationEngine::setNotificationOwner(uint notificationId, QNotifications *owner,
+                                                       uint replacedId)
+{
+    if (notificationId == 0)
+        return;
+    QMutexLocker locker(&m_ownersMutex);
+    // The send may complete after its owner was destroyed
+    if (!m_liveOwners.contains(owner))
+        return;
+    if (replacedId != 0 && replacedId != notificationId)
+        m_owners.remove(replacedId);
+    if (m_owners.size() >= MaximumNotificationOwners && !m_owners.contains(notificationId))
+        pruneNotificationOwners();
+    m_owners.insert(notificationId, { owner, ++m_lastOwnerSerial });
+}
+
+QList<uint> QPlatformNotificationEngine::notificationsOwnedBy(const QNotifications *owner) const
+{
+    QMutexLocker locker(&m_ownersMutex);
+    QList<uint> notificationIds;
+    for (auto it = m_owners.cbegin(); it != m_owners.cend(); ++it) {
+        if (it.value().owner == owner)
+            notificationIds.append(it.key());
+    }
+    return notificationIds;
+}
+
+void QPlatformNotificationEngine::removeNotificationOwner(const QNotifications *owner)
+{
+    QMutexLocker locker(&m_ownersMutex);
+    m_liveOwners.remove(owner);
+    m_owners.removeIf([owner](const auto &entry) { return entry.value().owner == owner; });
+}
+
+/*
+    Forgets the owners of all notifications. Engines call this when the
+    notifications shown so far are gone, such as when the notification server
+    was replaced; their IDs may be assigned to other notifications afterwards.
+*/
+void QPlatformNotificationEngine::clearNotificationOwners()
+{
+    QMutexLocker locker(&m_ownersMutex);
+    m_owners.clear();
+}
+
+// Drops the older half of the entries. Called with m_ownersMutex locked.
+void QPlatformNotificationEngine::pruneNotificationOwners()
+{
+    QList<quint64> serials;
+    serials.reserve(m_owners.size());
+    for (const NotificationOwner &entry : std::as_const(m_owners))
+        serials.append(entry.serial);
+    const auto median = serials.begin() + serials.size() / 2;
+    std::nth_element(serials.begin(), median, serials.end());
+    const quint64 oldestKept = *median;
+    m_owners.removeIf([oldestKept](const auto &entry) { return entry.value().serial < oldestKept; });
+}
+
+QNotifications *QPlatformNotificationEngine::notificationOwner(uint notificationId, bool release)
+{
+    QMutexLocker locker(&m_ownersMutex);
+    const auto it = m_owners.find(notificationId);
+    if (it == m_owners.end())
+        return nullptr;
+    QNotifications *owner = it.value().owner;
+    if (release)
+        m_owners.erase(it);
+    return owner;
+}
+
+/*
+    Sends \a request for \a owner and waits for its ID. When the engine lives
+    in another thread, the send is made there.
+*/
+uint QPlatformNotificationEngine::sendOwnedNotification(const QNotificationRequest &request, QNotifications *owner)
+{
+    if (thread() != QThread::currentThread()) {
+        QFuture<uint> future = sendOwnedNotificationAsync(request, owner);
+        future.waitForFinished();
+        return future.resultCount() > 0 ? future.result() : 0u;
+    }
+    const uint notificationId = sendNotification(request);
+    setNotificationOwner(notificationId, owner);
+    return notificationId;
+}
+
+/*
+    Sends \a request for \a owner. The owner is registered by a continuation
+    attached in the engine's thread, which runs there as soon as the ID is
+    known, before the engine can handle any event about the notification.
+*/
+QFuture<uint> QPlatformNotificationEngine::sendOwnedNotificationAsync(const QNotificationRequest &request,
+                                                                      QNotifications *owner)
+{
+    if (thread() != QThread::currentThread()) {
+        return runInEngineThread<uint>([this, request, owner] {
+            return sendOwnedNotificationAsync(request, owner);
+        });
+    }
+    return sendNotificationAsync(request).then(QtFuture::Launch::Sync, [this, owner](uint notificationId) {
+        setNotificationOwner(notificationId, owner);
+        return notificationId;
+    });
+}
+
+QFuture<QList<uint>> QPlatformNotificationEngine::sendOwnedNotifications(const QList<QNotificationRequest> &requests,
+                                                                         QNotifications *owner)
+{
+    if (thread() != QThread::currentThread()) {
+        return runInEngineThread<QList<uint>>([this, requests, owner] {
+            return sendOwnedNotifications(requests, owner);
+        });
+    }
+    return sendNotifications(requests).then(QtFuture::Launch::Sync, [this, owner](const QList<uint> &notificationIds) {
+        for (uint notificationId : notificationIds)
+            setNotificationOwner(notificationId, owner);
+        return notificationIds;
+    });
+}
+
+// The update may be shown under a new ID, which then replaces notificationId
+QFuture<uint> QPlatformNotificationEngine::updateOwnedNotification(uint notificationId,
+                                                                   const QNotificationRequest &request,
+                                                                   QNotifications *owner)
+{
+    if (thread() != QThread::currentThread()) {
+        return runInEngineThread<uint>([this, notificationId, request, owner] {
+            return updateOwnedNotification(notificationId, request, owner);
+        });
+    }
+    return updateNotification(notificationId, request).then(QtFuture::Launch::Sync,
+                                                           [this, owner, notificationId](uint updatedId) {
+        setNotificationOwner(updatedId, owner, notificationId);
+        return updatedId;
+    });
+}
+
+QFuture<uint> QPlatformNotificationEngine::sendNotificationAsync(const QNotificationRequest &request)
+{
+    // Engines without a native asynchronous path complete immediately
+    return QtFuture::makeReadyValueFuture(sendNotification(request));
+}
+
+bool QPlatformNotificationEngine::sendNotificationNoReply(const QNotificationRequest &request)
+{
+    return sendNotification(request) != 0;
+}
+
+QFuture<uint> QPlatformNotificationEngine::updateNotification(uint notificationId,
+                                                              const QNotificationRequest &request)
+{
+    // Engines that cannot replace notifications show the new state as a new one
+    Q_UNUSED(notificationId)
+    return sendNotificationAsync(request);
+}
+
+void QPlatformNotificationEngine::closeNotification(uint notificationId)
+{
+    // Engines that cannot withdraw notifications leave them to the user
+    Q_UNUSED(notificationId)
+}
+
+void QPlatformNotificationEngine::closeNotifications(const QList<uint> &notificationIds)
+{
+    for (uint notificationId : notificationIds)
+        closeNotification(notificationId);
+}
+
+QFuture<QList<uint>> QPlatformNotificationEngine::sendNotifications(const QList<QNotificationRequest> &requests)
+{
+    QList<QFuture<uint>> futures;
+    futures.reserve(requests.size());
+    for (const QNotificationRequest &request : requests)
+        futures.append(sendNotificationAsync(request));
+
+    return QtFuture::whenAll(futures.begin(), futures.end()).then([](const QList<QFuture<uint>> &results) {
+        QList<uint> ids;
+        ids.reserve(results.size());
+        for (const QFuture<uint> &result : results)
+            ids.append(result.isValid() && result.resultCount() > 0 ? result.result() : 0u);
+        return ids;
+    });
+}
+
+QStringList QPlatformNotificationEngine::capabilities() const
+{
+    // An empty list means the engine does not report what it supports
+    return QStringList();
+}
+
+bool QPlatformNotificationEngine::isAvailable() const
+{
+    // Engines without a separate server are available whenever they are supported
+    return isSupported();
+}
+
+void QPlatformNotificationEngine::prewarm()
+{
+}
+
+QNotifications::CircuitState QPlatformNotificationEngine::circuitState() const
+{
+    // Engines that cannot hang on a server never stop sending
+    return QNotifications::CircuitState::Closed;
+}
+
+void QPlatformNotificationEngine::setDefaultSendTimeout(int milliseconds)
+{
+    m_defaultSendTimeout.storeRelaxed(milliseconds < 0 ? -1 : milliseconds);
+}
+
+int QPlatformNotificationEngine::defaultSendTimeout() const
+{
+    return m_defaultSendTimeout.loadRelaxed();
+}
+
+// Returns the timeout of a send in milliseconds, or -1 for the platform's default
+int QPlatformNotificationEngine::sendTimeout(const QNotificationRequest &request) const
+{
+    return request.sendTimeout() >= 0 ? request.sendTimeout() : defaultSendTimeout();
+}
+
+void QPlatformNotificationEngine::adoptNotifications(const QList<uint> &notificationIds)
+{
+    // Engines that report every event of the application need no introduction
+    Q_UNUSED(notificationIds)
+}
+
+// Identifies the server that assigns notification IDs, so that IDs recorded in
+// a journal are only reused while the same server runs
+QString QPlatformNotificationEngine::serverIdentity() const
+{
+    // Engines whose IDs belong to the application need none
+    return QString();
+}
+
+#if defined(Q_OS_ANDROID)
+extern QPlatformNotificationEngine *qt_create_notification_engine_android();
+#elif defined(Q_OS_LINUX)
+extern QPlatformNotificationEngine *qt_create_notification_engine_linux();
+#elif defined(Q_OS_WIN)
+extern QPlatformNotificationEngine *qt_create_notification_engine_windows();
+#elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
+extern QPlatformNotificationEngine *qt_create_notification_engine_darwin();
+#endif
+
+namespace {
+
+struct QNotificationEngineRegistry
+{
+    QNotificationEngineRegistry()
+    {
+#if defined(Q_OS_ANDROID)
+        factories.insert(QStringLiteral("android"), qt_create_notification_engine_android);
+#elif defined(Q_OS_LINUX)
+        factories.insert(QStringLiteral("linux"), qt_create_notification_engine_linux);
+#elif defined(Q_OS_WIN)
+        factories.insert(QStringLiteral("windows"), qt_create_notification_engine_windows);
+#elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
+        factories.insert(QStringLiteral("darwin"), qt_create_notification_engine_darwin);
+#endif
+        factories.insert(QStringLiteral("loopback"), qt_create_notification_engine_loopback);
+    }
+
+    QMutex mutex;
+    QHash<QString, QNotificationEngineFactory> factories;
+};
+
+} // namespace
+
+Q_GLOBAL_STATIC(QNotificationEngineRegistry, notificationEngineRegistry)
+
+void qt_register_notification_engine(const QString &name, QNotificationEngineFactory factory)
 {
+    QNotificationEngineRegistry *registry = notificationEngineRegistry();
+    QMutexLocker locker(&registry->mutex);
+    if (factory)
+        registry->factories.insert(name, factory);
+    else
+        registry->factories.remove(name);
+}
+
+QStringList qt_notification_engines()
+{
+    QNotificationEngineRegistry *registry = notificationEngineRegistry();
+    QMutexLocker locker(&registry->mutex);
+    QStringList names = registry->factories.keys();
+    names.sort();
+    return names;
+}
+
+QString qt_default_notification_engine()
+{
+    const QString requested = qEnvironmentVariable("QT_NOTIFICATIONS_ENGINE");
+    if (!requested.isEmpty())
+        return requested;
 #if defined(Q_OS_ANDROID)
-    extern QPlatformNotificationEngine *qt_create_notification_engine_android();
-    return qt_create_notification_engine_android();
+    return QStringLiteral("android");
 #elif defined(Q_OS_LINUX)
-    extern QPlatformNotificationEngine *qt_create_notification_engine_linux();
-    return qt_create_notification_engine_linux();
+    return QStringLiteral("linux");
 #elif defined(Q_OS_WIN)
-    extern QPlatformNotificationEngine *qt_create_notification_engine_windows();
-    return qt_create_notification_engine_windows();
+    return QStringLiteral("windows");
 #elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
-    extern QPlatformNotificationEngine *qt_create_notification_engine_darwin();
-    return qt_create_notification_engine_darwin();
+    return QStringLiteral("darwin");
 #else
-    return nullptr;
+    // The loopback engine shows nothing, so it is only used when asked for
+    return QString();
 #endif
 }
 
+QPlatformNotificationEngine *qt_notification_engine(const QString &name)
+{
+    const QString engineName = name.isEmpty() ? qt_default_notification_engine() : name;
+    if (engineName.isEmpty())
+        return nullptr;
+
+    QNotificationEngineFactory factory = nullptr;
+    {
+        QNotificationEngineRegistry *registry = notificationEngineRegistry();
+        QMutexLocker locker(&registry->mutex);
+        factory = registry->factories.value(engineName);
+    }
+    if (!factory) {
+        qWarning("QtNotifications: Unknown notification engine \"%s\"", qPrintable(engineName));
+        return nullptr;
+    }
+
+    QPlatformNotificationEngine *engine = factory();
+    if (engine && engine->objectName().isEmpty())
+        engine->setObjectName(engineName);
+    return engine;
+}
+
 QT_END_NAMESPACE
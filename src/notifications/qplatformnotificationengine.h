@@ -2,32 +2,172 @@
 #define QPLATFORMNOTIFICATIONENGINE_H
 
 #include <QtNotifications/qnotifications.h>
+#include <QtNotifications/qnotificationrequest.h>
+#include <QtNotifications/qnotificationsstatistics.h>
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QFuture>
+#include <QtCore/QPromise>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QAtomicInteger>
+
+#include <array>
+#include <memory>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
-class QPlatformNotificationEngine : public QObject
+class QNotificationSubmissionQueue;
+
+class Q_NOTIFICATIONS_EXPORT QPlatformNotificationEngine : public QObject
 {
     Q_OBJECT
 public:
-    explicit QPlatformNotificationEngine(QObject *parent = nullptr) : QObject(parent) {}
-    virtual ~QPlatformNotificationEngine() = default;
+    explicit QPlatformNotificationEngine(QObject *parent = nullptr);
+    virtual ~QPlatformNotificationEngine();
 
     virtual bool isSupported() const = 0;
-    virtual uint sendNotification(const QString &title,
-                                 const QString &message,
-                                 const QVariantMap &parameters,
-                                 const QMap<QString, QString> &actions) = 0;
+    virtual uint sendNotification(const QNotificationRequest &request) = 0;
+    virtual QFuture<uint> sendNotificationAsync(const QNotificationRequest &request);
+    virtual QFuture<QList<uint>> sendNotifications(const QList<QNotificationRequest> &requests);
+    virtual bool sendNotificationNoReply(const QNotificationRequest &request);
+    virtual QFuture<uint> updateNotification(uint notificationId, const QNotificationRequest &request);
+    virtual void closeNotification(uint notificationId);
+    virtual void closeNotifications(const QList<uint> &notificationIds);
+    virtual QStringList capabilities() const;
+    virtual bool isAvailable() const;
+    virtual void prewarm();
+    virtual void adoptNotifications(const QList<uint> &notificationIds);
+    virtual QNotifications::CircuitState circuitState() const;
+    virtual QString serverIdentity() const;
+
+    void setDefaultSendTimeout(int milliseconds);
+    int defaultSendTimeout() const;
+    int sendTimeout(const QNotificationRequest &request) const;
+
+    void addNotificationOwner(QNotifications *owner);
+    void setNotificationOwner(uint notificationId, QNotifications *owner, uint replacedId = 0);
+    QList<uint> notificationsOwnedBy(const QNotifications *owner) const;
+    void removeNotificationOwner(const QNotifications *owner);
+    void clearNotificationOwners();
+
+    // Run in the engine's thread, so that the owner is known before the engine
+    // handles any event about the notifications sent
+    uint sendOwnedNotification(const QNotificationRequest &request, QNotifications *owner);
+    QFuture<uint> sendOwnedNotificationAsync(const QNotificationRequest &request, QNotifications *owner);
+    QFuture<QList<uint>> sendOwnedNotifications(const QList<QNotificationRequest> &requests, QNotifications *owner);
+    QFuture<uint> updateOwnedNotification(uint notificationId, const QNotificationRequest &request,
+                                          QNotifications *owner);
+
+    QFuture<uint> submitNotification(const QNotificationRequest &request, QNotifications *owner);
+
+    // Calls function in the thread of owner unless owner is being destroyed;
+    // safe to call from any thread
+    template <typename Function>
+    void invokeOnOwner(QNotifications *owner, Function &&function)
+    {
+        {
+            // Held while posting, so that the owner cannot be destroyed meanwhile
+            QMutexLocker locker(&m_ownersMutex);
+            if (!m_liveOwners.contains(owner))
+                return;
+            if (owner->thread() != QThread::currentThread()) {
+                QMetaObject::invokeMethod(owner, std::forward<Function>(function), Qt::QueuedConnection);
+                return;
+            }
+        }
+        // Called without the lock, as the function may call back into the engine
+        function();
+    }
+
+    // Counters behind QNotifications::statistics(); safe to call from any thread
+    QNotificationsStatistics statistics() const;
+    qint64 recordSendStarted(qsizetype count = 1);
+    void recordSendFinished(qint64 startedAt, qsizetype sent, qsizetype failed);
+    void recordUpdateFinished(qint64 startedAt, bool succeeded);
+    void recordPosted();
+    void recordDroppedSignal();
+    void recordBytesMarshalled(qint64 bytes);
 
 signals:
+    void capabilitiesChanged();
+    void availabilityChanged(bool available);
+    void circuitStateChanged(QNotifications::CircuitState state);
+    void serverIdentityChanged(const QString &serverIdentity);
     void actionInvoked(uint notificationId, const QString &actionKey);
     void notificationClosed(uint notificationId, QNotifications::ClosedReason reason);
     void notificationClicked(uint notificationId);
+
+protected:
+    // Runs function, which returns a future, in the engine's thread, and
+    // returns a future of its result
+    template <typename T, typename Function>
+    QFuture<T> runInEngineThread(Function function)
+    {
+        auto promise = std::make_shared<QPromise<T>>();
+        QFuture<T> future = promise->future();
+        promise->start();
+        QMetaObject::invokeMethod(this, [promise, function]() mutable {
+            function().then(QtFuture::Launch::Sync, [promise](const T &result) {
+                promise->addResult(result);
+                promise->finish();
+            }).onCanceled([promise] {
+                promise->future().cancel();
+                promise->finish();
+            });
+        }, Qt::QueuedConnection);
+        return future;
+    }
+
+private:
+    QNotifications *notificationOwner(uint notificationId, bool release = false);
+    void pruneNotificationOwners();
+    void drainSubmissions();
+    void recordReplies(qint64 startedAt, qsizetype count);
+
+    // Events about a notification are delivered only to the QNotifications
+    // object that sent it
+    struct NotificationOwner
+    {
+        QNotifications *owner = nullptr;
+        // Order of registration, so that the oldest entries are evicted first
+        quint64 serial = 0;
+    };
+    mutable QMutex m_ownersMutex;
+    // QNotifications objects between their construction and destruction
+    QSet<const QNotifications *> m_liveOwners;
+    QHash<uint, NotificationOwner> m_owners;
+    quint64 m_lastOwnerSerial = 0;
+
+    // Notifications submitted from any thread, sent from the engine's thread
+    std::unique_ptr<QNotificationSubmissionQueue> m_submissions;
+    QAtomicInteger<bool> m_drainScheduled;
+
+    QAtomicInteger<int> m_defaultSendTimeout = -1;
+
+    // Updated with relaxed atomics only, so that they can always be kept
+    static constexpr qsizetype LatencyBucketCount = 13;
+    QAtomicInteger<quint64> m_sentCount;
+    QAtomicInteger<quint64> m_failedCount;
+    QAtomicInteger<quint64> m_updatedCount;
+    QAtomicInteger<quint64> m_closedCount;
+    QAtomicInteger<quint64> m_droppedSignalCount;
+    QAtomicInteger<qint64> m_inFlightCount;
+    QAtomicInteger<quint64> m_bytesMarshalled;
+    std::array<QAtomicInteger<quint64>, LatencyBucketCount> m_latencyHistogram;
 };
 
-QPlatformNotificationEngine *qt_notification_engine();
+using QNotificationEngineFactory = QPlatformNotificationEngine *(*)();
+
+Q_NOTIFICATIONS_EXPORT void qt_register_notification_engine(const QString &name, QNotificationEngineFactory factory);
+Q_NOTIFICATIONS_EXPORT QStringList qt_notification_engines();
+Q_NOTIFICATIONS_EXPORT QString qt_default_notification_engine();
+QPlatformNotificationEngine *qt_notification_engine(const QString &name = QString());
 
 QT_END_NAMESPACE
 
@@ -1,4 +1,5 @@
 #include "qplatformnotificationengine_android.h"
+#include "qnotificationiconcache_p.h"
 #include <QtCore/qdebug.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qhash.h>
@@ -68,10 +69,7 @@ static QJniObject jniObjectFromQVariant(const QVariant &value)
     return QJniObject();
 }
 
-uint QPlatformNotificationEngineAndroid::sendNotification(const QString &title,
-                                                          const QString &message,
-                                                          const QVariantMap &parameters,
-                                                          const QMap<QString, QString> &actions)
+uint QPlatformNotificationEngineAndroid::sendNotification(const QNotificationRequest &request)
 {
     if (!m_javaObject.isValid()) {
         qWarning("QtNotifications Android: Java object not initialized");
@@ -81,6 +79,15 @@ uint QPlatformNotificationEngineAndroid::sendNotification(const QString &title,
     QJniObject javaParameters("java/util/HashMap", "()V");
     QJniObject javaActions("java/util/HashMap", "()V");
 
+    QVariantMap parameters = request.hints();
+    if (!request.image().isNull() && !parameters.contains(QStringLiteral("largeIconData"))
+        && !parameters.contains(QStringLiteral("largeIconPath"))) {
+        const QString path = QNotificationIconCache::instance()->pathForImage(request.image());
+        if (!path.isEmpty())
+            parameters.insert(QStringLiteral("largeIconPath"), path);
+    }
+    const QStringList actions = request.actions();
+
     qDebug() << "QtNotifications Android: Parameters" << parameters;
     for (auto it = parameters.constBegin(); it != parameters.constEnd(); ++it) {
         QJniObject key = QJniObject::fromString(it.key());
@@ -114,10 +121,10 @@ uint QPlatformNotificationEngineAndroid::sendNotification(const QString &title,
         }
     }
 
-    qDebug() << "QtNotifications Android: Actions" << actions.size();
-    for (auto it = actions.constBegin(); it != actions.constEnd(); ++it) {
-        QJniObject key = QJniObject::fromString(it.key());
-        QJniObject value = QJniObject::fromString(it.value());
+    qDebug() << "QtNotifications Android: Actions" << request.actionCount();
+    for (qsizetype i = 0; i + 1 < actions.size(); i += 2) {
+        QJniObject key = QJniObject::fromString(actions.at(i));
+        QJniObject value = QJniObject::fromString(actions.at(i + 1));
         javaActions.callObjectMethod("put",
                                     "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;",
                                     key.object<jobject>(),
@@ -128,14 +135,23 @@ uint QPlatformNotificationEngineAndroid::sendNotification(const QString &title,
     jint result = m_javaObject.callMethod<jint>(
         "sendNotification",
         "(Ljava/lang/String;Ljava/lang/String;Ljava/util/Map;Ljava/util/Map;)I",
-        QJniObject::fromString(title).object<jstring>(),
-        QJniObject::fromString(message).object<jstring>(),
+        QJniObject::fromString(request.title()).object<jstring>(),
+        QJniObject::fromString(request.message()).object<jstring>(),
         javaParameters.object<jobject>(),
         javaActions.object<jobject>());
 
     return result;
 }
 
+void QPlatformNotificationEngineAndroid::closeNotification(uint notificationId)
+{
+    if (!m_javaObject.isValid() || notificationId == 0)
+        return;
+
+    m_javaObject.callMethod<void>("cancelNotification", "(I)V", jint(notificationId));
+    emit notificationClosed(notificationId, QNotifications::Closed);
+}
+
 // JNI callback functions
 extern "C" {
 
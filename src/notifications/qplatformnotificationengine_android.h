@@ -20,10 +20,8 @@ public:
     explicit QPlatformNotificationEngineAndroid(QObject *parent = nullptr);
 
     bool isSupported() const override;
-    uint sendNotification(const QString &title,
-                          const QString &message,
-                          const QVariantMap &parameters,
-                          const QMap<QString, QString> &actions) override;
+    uint sendNotification(const QNotificationRequest &request) override;
+    void closeNotification(uint notificationId) override;
 
 private:
     QJniObject m_javaObject;
@@ -24,10 +24,9 @@ public:
     void handleNotificationClicked(const QString &notificationIdentifier);
 
     bool isSupported() const override;
-    uint sendNotification(const QString &title,
-                         const QString &message,
-                         const QVariantMap &parameters,
-                         const QMap<QString, QString> &actions) override;
+    uint sendNotification(const QNotificationRequest &request) override;
+    void closeNotification(uint notificationId) override;
+    void closeNotifications(const QList<uint> &notificationIds) override;
 
 private:
     DarwinNotificationDelegate* m_delegate;
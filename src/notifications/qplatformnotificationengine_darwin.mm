@@ -1,5 +1,7 @@
 #include "qplatformnotificationengine_darwin.h"
+#include "qnotificationiconcache_p.h"
 #include <QtCore/qglobal.h>
+#include <QtCore/qset.h>
 #import <Foundation/Foundation.h>
 #import <UserNotifications/UserNotifications.h>
 
@@ -124,7 +126,7 @@ bool QPlatformNotificationEngineDarwin::isSupported() const
     return true;
 }
 
-uint QPlatformNotificationEngineDarwin::sendNotification(const QString &title, const QString &message, const QVariantMap &parameters, const QMap<QString, QString> &actions)
+uint QPlatformNotificationEngineDarwin::sendNotification(const QNotificationRequest &request)
 {
     UNUserNotificationCenter *center = [UNUserNotificationCenter currentNotificationCenter];
 
@@ -154,8 +156,8 @@ uint QPlatformNotificationEngineDarwin::sendNotification(const QString &title, c
     }
 
     UNMutableNotificationContent *content = [[UNMutableNotificationContent alloc] init];
-    content.title = title.toNSString();
-    content.body = message.toNSString();
+    content.title = request.title().toNSString();
+    content.body = request.message().toNSString();
 
     // Collect all image attachments from parameters
     // Supported keys: "icon", "image", "attachment", "image1", "image2", etc.
@@ -231,12 +233,16 @@ uint QPlatformNotificationEngineDarwin::sendNotification(const QString &title, c
         }
     };
 
-    QString icon = parameters.value(QStringLiteral("icon")).toString();
+    const QVariantMap parameters = request.hints();
+
+    QString icon = request.icon();
     if (!icon.isEmpty()) {
         addAttachmentFromPath(icon.toNSString(), @"notification-icon");
     }
 
     QString image = parameters.value(QStringLiteral("image")).toString();
+    if (image.isEmpty() && !request.image().isNull())
+        image = QNotificationIconCache::instance()->pathForImage(request.image());
     if (!image.isEmpty()) {
         addAttachmentFromPath(image.toNSString(), @"notification-image");
     }
@@ -252,9 +258,10 @@ uint QPlatformNotificationEngineDarwin::sendNotification(const QString &title, c
     }
 
     NSMutableArray *actionArray = [NSMutableArray array];
-    for (auto it = actions.constBegin(); it != actions.constEnd(); ++it) {
-        NSString *actionKey = it.key().toNSString();
-        NSString *actionLabel = it.value().toNSString();
+    const QStringList actions = request.actions();
+    for (qsizetype i = 0; i + 1 < actions.size(); i += 2) {
+        NSString *actionKey = actions.at(i).toNSString();
+        NSString *actionLabel = actions.at(i + 1).toNSString();
         UNNotificationAction *action = [UNNotificationAction actionWithIdentifier:actionKey title:actionLabel options:UNNotificationActionOptionForeground];
         [actionArray addObject:action];
     }
@@ -286,6 +293,36 @@ uint QPlatformNotificationEngineDarwin::sendNotification(const QString &title, c
     return notificationId;
 }
 
+void QPlatformNotificationEngineDarwin::closeNotification(uint notificationId)
+{
+    closeNotifications({ notificationId });
+}
+
+void QPlatformNotificationEngineDarwin::closeNotifications(const QList<uint> &notificationIds)
+{
+    NSMutableArray<NSString *> *identifiers = [NSMutableArray array];
+    QList<uint> closedIds;
+    const QSet<uint> ids(notificationIds.cbegin(), notificationIds.cend());
+    for (auto it = m_notificationIdMap.begin(); it != m_notificationIdMap.end();) {
+        if (ids.contains(it.value())) {
+            [identifiers addObject:it.key().toNSString()];
+            closedIds.append(it.value());
+            it = m_notificationIdMap.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if ([identifiers count] == 0)
+        return;
+
+    // Notifications still waiting for their trigger are pending, all others delivered
+    UNUserNotificationCenter *center = [UNUserNotificationCenter currentNotificationCenter];
+    [center removePendingNotificationRequestsWithIdentifiers:identifiers];
+    [center removeDeliveredNotificationsWithIdentifiers:identifiers];
+    for (uint notificationId : std::as_const(closedIds))
+        emit notificationClosed(notificationId, QNotifications::Closed);
+}
+
 QPlatformNotificationEngine *qt_create_notification_engine_darwin()
 {
     static QPlatformNotificationEngineDarwin engine;
@@ -1,97 +1,892 @@
 #include "qplatformnotificationengine_linux.h"
+#include "qnotificationiconcache_p.h"
 #include <QtDBus/QtDBus>
+#include <QtCore/private/qtrace_p.h>
+#include <QtCore/QFileInfo>
+#include <QtCore/QPromise>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QThread>
+
+#include <memory>
+#include <utility>
+
+#include <qtnotifications_tracepoints_p.h>
 
 QT_BEGIN_NAMESPACE
 
+// Wraps a QImage so that it is marshalled as the (iiibiiay) image-data hint
+// directly from its pixel buffer, when the D-Bus message is serialized
+struct QNotificationDBusImage
+{
+    QImage image;
+};
+
+static QDBusArgument &operator<<(QDBusArgument &argument, const QNotificationDBusImage &imageData)
+{
+    const QImage &image = imageData.image;
+    const bool hasAlpha = image.hasAlphaChannel();
+    argument.beginStructure();
+    argument << image.width()
+             << image.height()
+             << int(image.bytesPerLine())
+             << hasAlpha
+             << 8
+             << (hasAlpha ? 4 : 3);
+    // Borrow the pixels instead of copying them into an intermediate QByteArray
+    argument << QByteArray::fromRawData(reinterpret_cast<const char *>(image.constBits()),
+                                        image.sizeInBytes());
+    argument.endStructure();
+    return argument;
+}
+
+static const QDBusArgument &operator>>(const QDBusArgument &argument, QNotificationDBusImage &)
+{
+    // Images are only ever sent to the notification server
+    return argument;
+}
+
+static QNotificationDBusImage dbusImage(const QImage &image)
+{
+    // The specification wants RGB or RGBA with 8 bits per sample; images that
+    // already use that layout are shared, everything else is converted once
+    const QImage::Format format = image.hasAlphaChannel() ? QImage::Format_RGBA8888
+                                                          : QImage::Format_RGB888;
+    if (image.format() == format)
+        return { image };
+    return { image.convertToFormat(format) };
+}
+
+// Reduces the markup subset of the specification (b, i, u, a, img) to plain text.
+// Only those tags are removed, so that text such as "a < b and c > d" is kept
+static QString plainTextFromMarkup(const QString &markup)
+{
+    static const QRegularExpression tags(QStringLiteral("</?(?:b|i|u|a|img)(?:\\s[^>]*)?/?>"),
+                                         QRegularExpression::CaseInsensitiveOption);
+    QString text = markup;
+    text.remove(tags);
+    text.replace(QStringLiteral("&lt;"), QStringLiteral("<"));
+    text.replace(QStringLiteral("&gt;"), QStringLiteral(">"));
+    text.replace(QStringLiteral("&quot;"), QStringLiteral("\""));
+    text.replace(QStringLiteral("&apos;"), QStringLiteral("'"));
+    text.replace(QStringLiteral("&amp;"), QStringLiteral("&"));
+    return text;
+}
+
+// Approximates the wire size of a string for the statistics: text counts one
+// byte per character, and padding is ignored
+static qint64 marshalledSize(const QString &string)
+{
+    return 5 + string.size();
+}
+
+// Approximates the wire size of a hint value. The hints of the specification
+// are strings, integers, booleans and images, so values are not descended into
+static qint64 marshalledHintSize(const QVariant &value)
+{
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return 5 + static_cast<const QString *>(value.constData())->size();
+    case QMetaType::QByteArray:
+        return 4 + static_cast<const QByteArray *>(value.constData())->size();
+    default:
+        break;
+    }
+    if (value.userType() == qMetaTypeId<QNotificationDBusImage>())
+        return 6 * 4 + 4 + static_cast<const QNotificationDBusImage *>(value.constData())->image.sizeInBytes();
+    // Integers and booleans; a prebuilt QDBusArgument is not measured
+    return value.userType() == qMetaTypeId<QDBusArgument>() ? 0 : 4;
+}
+
+// Servers number their notifications from the start whenever they are
+// started. A server is told apart from its predecessors by its unique bus name,
+// and by the boot ID from servers of earlier boots that got the same name
+static QString linuxServerIdentity(const QString &serverOwner)
+{
+    static const QString bootId = [] {
+        QFile file(QStringLiteral("/proc/sys/kernel/random/boot_id"));
+        return file.open(QIODevice::ReadOnly) ? QString::fromLatin1(file.readAll().trimmed()) : QString();
+    }();
+    return bootId + QLatin1Char('/') + serverOwner;
+}
+
+// The circuit breaker opens after this many failed sends in a row, and probes
+// the server with a backoff between these bounds, in milliseconds
+static constexpr int CircuitFailureThreshold = 3;
+static constexpr int InitialProbeBackoff = 1000;
+static constexpr int MaximumProbeBackoff = 60000;
+
+// Whether a call failed because the server did not answer it, as opposed to
+// an error reply, which shows that the server is there and answering
+static bool isServerFailure(QDBusError::ErrorType error)
+{
+    switch (error) {
+    case QDBusError::NoReply:
+    case QDBusError::Timeout:
+    case QDBusError::TimedOut:
+    case QDBusError::ServiceUnknown:
+    case QDBusError::Disconnected:
+        return true;
+    default:
+        return false;
+    }
+}
+
 QPlatformNotificationEngineLinux::QPlatformNotificationEngineLinux(QObject *parent)
 : QPlatformNotificationEngine(parent)
 {
-    QDBusConnection::sessionBus().connect(
+    qDBusRegisterMetaType<QNotificationDBusImage>();
+
+    // Connecting to the session bus blocks, so it is left to the event loop
+    // of the engine's thread
+    QMetaObject::invokeMethod(this, &QPlatformNotificationEngineLinux::ensureInitialized, Qt::QueuedConnection);
+}
+
+void QPlatformNotificationEngineLinux::ensureInitialized()
+{
+    if (m_initialized)
+        return;
+    m_initialized = true;
+
+    // Created here rather than in the constructor, so that it belongs to the
+    // engine's thread from the start
+    m_probeTimer = new QTimer(this);
+    m_probeTimer->setSingleShot(true);
+    connect(m_probeTimer, &QTimer::timeout, this, &QPlatformNotificationEngineLinux::probeServer);
+
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    m_busConnected.storeRelease(bus.isConnected() ? 1 : 0);
+    if (!bus.isConnected()) {
+        updateAvailability();
+        return;
+    }
+
+    // A different server may support different features, so the cached
+    // capabilities are refetched whenever the bus name changes owner
+    const QString service = QStringLiteral("org.freedesktop.Notifications");
+    auto *serviceWatcher = new QDBusServiceWatcher(service, bus, QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(serviceWatcher, &QDBusServiceWatcher::serviceOwnerChanged,
+            this, &QPlatformNotificationEngineLinux::onServiceOwnerChanged);
+
+    // Which server is running, if any, and whether one can be started by the
+    // bus, is asked without blocking; until both answers arrive, the server
+    // counts as available
+    m_availabilityQueriesPending = 2;
+    QDBusMessage owner = QDBusMessage::createMethodCall(
+        QStringLiteral("org.freedesktop.DBus"),
+        QStringLiteral("/org/freedesktop/DBus"),
+        QStringLiteral("org.freedesktop.DBus"),
+        QStringLiteral("GetNameOwner"));
+    owner.setArguments({ service });
+    auto *ownerWatcher = new QDBusPendingCallWatcher(bus.asyncCall(owner), this);
+    connect(ownerWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QDBusPendingReply<QString> reply = *watcher;
+        // The owner may have been reported by the service watcher meanwhile
+        if (reply.isValid() && m_serviceOwner.isEmpty())
+            setServiceOwner(reply.value());
+        m_serviceHasOwner = !m_serviceOwner.isEmpty();
+        // Asking a running server does not start one that is not running
+        if (m_serviceHasOwner && !m_capabilitiesKnown)
+            fetchCapabilities();
+        --m_availabilityQueriesPending;
+        updateAvailability();
+    });
+
+    QDBusMessage activatable = QDBusMessage::createMethodCall(
+        QStringLiteral("org.freedesktop.DBus"),
+        QStringLiteral("/org/freedesktop/DBus"),
+        QStringLiteral("org.freedesktop.DBus"),
+        QStringLiteral("ListActivatableNames"));
+    auto *activatableWatcher = new QDBusPendingCallWatcher(bus.asyncCall(activatable), this);
+    connect(activatableWatcher, &QDBusPendingCallWatcher::finished, this, [this, service](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QDBusPendingReply<QStringList> reply = *watcher;
+        m_serviceActivatable = reply.isValid() && reply.value().contains(service);
+        --m_availabilityQueriesPending;
+        updateAvailability();
+    });
+}
+
+void QPlatformNotificationEngineLinux::updateAvailability()
+{
+    if (m_availabilityQueriesPending > 0 && !m_serviceHasOwner)
+        return;
+    const bool available = m_busConnected.loadAcquire() == 1 && (m_serviceHasOwner || m_serviceActivatable);
+    if (m_available.fetchAndStoreRelease(available) != available)
+        emit availabilityChanged(available);
+}
+
+bool QPlatformNotificationEngineLinux::isSupported() const
+{
+    const int connected = m_busConnected.loadAcquire();
+    if (connected >= 0)
+        return connected == 1;
+    // Not connected yet; a session bus is expected where its address is known
+    return !qEnvironmentVariableIsEmpty("DBUS_SESSION_BUS_ADDRESS")
+            || QFileInfo::exists(qEnvironmentVariable("XDG_RUNTIME_DIR") + QStringLiteral("/bus"));
+}
+
+QString QPlatformNotificationEngineLinux::serverIdentity() const
+{
+    // Asked once when a journal is opened, so a blocking call is acceptable;
+    // without a server, no recorded ID can still be shown
+    QString serverOwner;
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (bus.isConnected()) {
+        const QDBusReply<QString> reply = bus.interface()->serviceOwner(QStringLiteral("org.freedesktop.Notifications"));
+        if (reply.isValid())
+            serverOwner = reply.value();
+    }
+    return linuxServerIdentity(serverOwner);
+}
+
+bool QPlatformNotificationEngineLinux::isAvailable() const
+{
+    return isSupported() && m_available.loadAcquire();
+}
+
+void QPlatformNotificationEngineLinux::prewarm()
+{
+    if (!isEngineThread()) {
+        QMetaObject::invokeMethod(this, &QPlatformNotificationEngineLinux::prewarm, Qt::QueuedConnection);
+        return;
+    }
+    ensureInitialized();
+    if (m_prewarmed || m_busConnected.loadAcquire() != 1)
+        return;
+    m_prewarmed = true;
+
+    // Start the server now rather than on the first Notify call, then have it
+    // answer a call, so that its first notification does not pay for start-up
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    QDBusMessage start = QDBusMessage::createMethodCall(
+        QStringLiteral("org.freedesktop.DBus"),
+        QStringLiteral("/org/freedesktop/DBus"),
+        QStringLiteral("org.freedesktop.DBus"),
+        QStringLiteral("StartServiceByName"));
+    start.setArguments({ QStringLiteral("org.freedesktop.Notifications"), 0u });
+    auto *startWatcher = new QDBusPendingCallWatcher(bus.asyncCall(start), this);
+    connect(startWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QDBusMessage information = QDBusMessage::createMethodCall(
+            QStringLiteral("org.freedesktop.Notifications"),
+            QStringLiteral("/org/freedesktop/Notifications"),
+            QStringLiteral("org.freedesktop.Notifications"),
+            QStringLiteral("GetServerInformation"));
+        // Only the round trip matters: it completes once the server is serving
+        auto *informationWatcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(information), this);
+        connect(informationWatcher, &QDBusPendingCallWatcher::finished,
+                informationWatcher, &QObject::deleteLater);
+        if (!m_capabilitiesKnown)
+            fetchCapabilities();
+    });
+}
+
+void QPlatformNotificationEngineLinux::adoptNotifications(const QList<uint> &notificationIds)
+{
+    if (!isEngineThread()) {
+        QMetaObject::invokeMethod(this, [this, notificationIds] { adoptNotifications(notificationIds); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+    ensureInitialized();
+
+    // Notifications sent by an earlier run of the application are still ours
+    for (uint notificationId : notificationIds) {
+        if (notificationId != 0)
+            m_ownedIds.insert(notificationId);
+    }
+    updateSignalSubscription();
+}
+
+bool QPlatformNotificationEngineLinux::isEngineThread() const
+{
+    return QThread::currentThread() == thread();
+}
+
+uint QPlatformNotificationEngineLinux::sendNotification(const QNotificationRequest &request)
+{
+    if (!isEngineThread()) {
+        // Wait for the engine thread instead of calling the server from here
+        QFuture<uint> future = sendNotificationAsync(request);
+        future.waitForFinished();
+        return future.resultCount() > 0 ? future.result() : 0u;
+    }
+
+    ensureInitialized();
+    if (isCircuitOpen())
+        return 0;
+
+    beginSend();
+    const QDBusMessage message = createNotifyMessage(request);
+    Q_TRACE(QPlatformNotificationEngineLinux_dispatch, 0u, 1);
+    QDBusMessage reply = QDBusConnection::sessionBus().call(message, QDBus::Block, sendTimeout(request));
+    uint notificationId = 0;
+    if (reply.type() == QDBusMessage::ReplyMessage && !reply.arguments().isEmpty())
+        notificationId = reply.arguments().first().toUInt();
+    finishSend(notificationId, QDBusError(reply).type());
+    return notificationId;
+}
+
+QFuture<uint> QPlatformNotificationEngineLinux::sendNotificationAsync(const QNotificationRequest &request)
+{
+    if (!isEngineThread())
+        return runInEngineThread<uint>([this, request] { return sendNotificationAsync(request); });
+
+    ensureInitialized();
+    if (isCircuitOpen())
+        return QtFuture::makeReadyValueFuture(0u);
+
+    beginSend();
+    const QDBusMessage message = createNotifyMessage(request);
+    Q_TRACE(QPlatformNotificationEngineLinux_dispatch, 0u, 1);
+    QDBusPendingCall call = QDBusConnection::sessionBus().asyncCall(message, sendTimeout(request));
+    return notificationIdFuture(call);
+}
+
+bool QPlatformNotificationEngineLinux::sendNotificationNoReply(const QNotificationRequest &request)
+{
+    // No reply will tell whether the server got the notification, so none is
+    // written while it does not answer; it would only queue up in its socket
+    if (isCircuitOpen())
+        return false;
+    if (!isEngineThread()) {
+        QMetaObject::invokeMethod(this, [this, request] { sendNotificationNoReply(request); }, Qt::QueuedConnection);
+        return true;
+    }
+    ensureInitialized();
+
+    // QDBusConnection::send() flags method calls with NO_REPLY_EXPECTED,
+    // so neither the daemon nor the bus route a reply back to us
+    const QDBusMessage message = createNotifyMessage(request);
+    Q_TRACE(QPlatformNotificationEngineLinux_dispatch, 0u, 1);
+    return QDBusConnection::sessionBus().send(message);
+}
+
+QFuture<QList<uint>> QPlatformNotificationEngineLinux::sendNotifications(const QList<QNotificationRequest> &requests)
+{
+    if (!isEngineThread())
+        return runInEngineThread<QList<uint>>([this, requests] { return sendNotifications(requests); });
+
+    struct Batch
+    {
+        QPromise<QList<uint>> promise;
+        QList<uint> ids;
+        qsizetype pending = 0;
+    };
+
+    ensureInitialized();
+    auto batch = std::make_shared<Batch>();
+    QFuture<QList<uint>> future = batch->promise.future();
+    batch->promise.start();
+    batch->ids.resize(requests.size());
+    batch->pending = requests.size();
+    if (requests.isEmpty() || isCircuitOpen()) {
+        batch->promise.addResult(batch->ids);
+        batch->promise.finish();
+        return future;
+    }
+
+    // Write every Notify call to the connection before waiting for any reply,
+    // so the daemon processes the whole batch back-to-back
+    beginSend(requests.size());
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    for (qsizetype i = 0; i < requests.size(); ++i) {
+        const QDBusMessage message = createNotifyMessage(requests.at(i));
+        Q_TRACE(QPlatformNotificationEngineLinux_dispatch, 0u, int(requests.size()));
+        QDBusPendingCall call = bus.asyncCall(message, sendTimeout(requests.at(i)));
+        auto *watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, batch, i](QDBusPendingCallWatcher *watcher) {
+            QDBusPendingReply<uint> reply = *watcher;
+            batch->ids[i] = reply.isValid() ? reply.value() : 0u;
+            finishSend(batch->ids[i], reply.error().type());
+            if (--batch->pending == 0) {
+                batch->promise.addResult(batch->ids);
+                batch->promise.finish();
+            }
+            watcher->deleteLater();
+        });
+    }
+    return future;
+}
+
+QFuture<uint> QPlatformNotificationEngineLinux::updateNotification(uint notificationId,
+                                                                   const QNotificationRequest &request)
+{
+    if (!isEngineThread()) {
+        return runInEngineThread<uint>([this, notificationId, request] {
+            return updateNotification(notificationId, request);
+        });
+    }
+    if (notificationId == 0)
+        return sendNotificationAsync(request);
+    ensureInitialized();
+    if (isCircuitOpen())
+        return QtFuture::makeReadyValueFuture(0u);
+
+    auto promise = std::make_shared<QPromise<uint>>();
+    QFuture<uint> future = promise->future();
+    promise->start();
+
+    // While an update of this notification is in flight, later ones replace
+    // each other; the last of them is sent once the daemon has replied. An
+    // update made with an ID the server assigned meanwhile joins the same chain
+    const auto it = m_updates.find(m_updateAliases.value(notificationId, notificationId));
+    if (it != m_updates.end()) {
+        it->nextRequest = request;
+        it->nextPromises.append(std::move(promise));
+        return future;
+    }
+    m_updates.insert(notificationId, UpdateQueue());
+    dispatchUpdate(notificationId, notificationId, request, { promise });
+    return future;
+}
+
+void QPlatformNotificationEngineLinux::dispatchUpdate(uint notificationId, uint replacesId,
+                                                      const QNotificationRequest &request,
+                                                      const QList<std::shared_ptr<QPromise<uint>>> &promises)
+{
+    beginSend();
+    const QDBusMessage message = createNotifyMessage(request, replacesId);
+    Q_TRACE(QPlatformNotificationEngineLinux_dispatch, replacesId, 1);
+    QDBusPendingCall call = QDBusConnection::sessionBus().asyncCall(message, sendTimeout(request));
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, notificationId, replacesId, promises](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QDBusPendingReply<uint> reply = *watcher;
+        const uint id = reply.isValid() ? reply.value() : 0u;
+        finishSend(id, reply.error().type());
+        // Registered before the callers learn of the new ID, since they may
+        // update the notification with it right away
+        if (id != 0 && id != notificationId)
+            m_updateAliases.insert(id, notificationId);
+        for (const auto &promise : promises) {
+            promise->addResult(id);
+            promise->finish();
+        }
+
+        const auto it = m_updates.find(notificationId);
+        if (it != m_updates.end() && !it->nextPromises.isEmpty()) {
+            // The server assigns a new ID if the notification was gone already,
+            // so the coalesced update replaces whatever is shown now
+            const UpdateQueue next = std::exchange(*it, UpdateQueue());
+            dispatchUpdate(notificationId, id ? id : replacesId, next.nextRequest, next.nextPromises);
+            return;
+        }
+        if (it != m_updates.end())
+            m_updates.erase(it);
+        m_updateAliases.removeIf([notificationId](const auto &alias) {
+            return alias.value() == notificationId;
+        });
+    });
+}
+
+void QPlatformNotificationEngineLinux::closeNotification(uint notificationId)
+{
+    if (notificationId == 0)
+        return;
+    if (!isEngineThread()) {
+        QMetaObject::invokeMethod(this, [this, notificationId] { closeNotification(notificationId); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+
+    ensureInitialized();
+
+    // A coalesced update would show the notification again
+    const auto it = m_updates.find(m_updateAliases.value(notificationId, notificationId));
+    if (it != m_updates.end()) {
+        const UpdateQueue next = std::exchange(*it, UpdateQueue());
+        for (const auto &promise : next.nextPromises) {
+            promise->addResult(0u);
+            promise->finish();
+        }
+    }
+
+    // The server closes any ID it is given, including those of notifications
+    // of other applications
+    if (!m_ownedIds.contains(notificationId))
+        return;
+
+    QDBusMessage msg = QDBusMessage::createMethodCall(
         QStringLiteral("org.freedesktop.Notifications"),
         QStringLiteral("/org/freedesktop/Notifications"),
         QStringLiteral("org.freedesktop.Notifications"),
-        QStringLiteral("ActionInvoked"),
-        this,
-        SLOT(onActionInvoked(uint, QString))
-    );
-    QDBusConnection::sessionBus().connect(
+        QStringLiteral("CloseNotification"));
+    msg.setArguments({ notificationId });
+    // Sent without waiting for a reply, so closing many notifications writes all
+    // calls back-to-back; the server confirms each with NotificationClosed
+    QDBusConnection::sessionBus().send(msg);
+}
+
+void QPlatformNotificationEngineLinux::closeNotifications(const QList<uint> &notificationIds)
+{
+    // One hop to the engine thread for the whole list
+    if (!isEngineThread()) {
+        QMetaObject::invokeMethod(this, [this, notificationIds] { closeNotifications(notificationIds); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+    QPlatformNotificationEngine::closeNotifications(notificationIds);
+}
+
+QStringList QPlatformNotificationEngineLinux::capabilities() const
+{
+    QMutexLocker locker(&m_capabilitiesMutex);
+    return m_capabilities;
+}
+
+void QPlatformNotificationEngineLinux::fetchCapabilities()
+{
+    const quint64 generation = ++m_capabilitiesGeneration;
+    QDBusMessage msg = QDBusMessage::createMethodCall(
         QStringLiteral("org.freedesktop.Notifications"),
         QStringLiteral("/org/freedesktop/Notifications"),
         QStringLiteral("org.freedesktop.Notifications"),
-        QStringLiteral("NotificationClosed"),
-        this,
-        SLOT(onNotificationClosed(uint, uint))
-    );
+        QStringLiteral("GetCapabilities"));
+
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(msg), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QDBusPendingReply<QStringList> reply = *watcher;
+        if (generation != m_capabilitiesGeneration || !reply.isValid())
+            return;
+        {
+            QMutexLocker locker(&m_capabilitiesMutex);
+            m_capabilities = reply.value();
+        }
+        m_capabilitiesKnown = true;
+        emit capabilitiesChanged();
+    });
 }
 
-bool QPlatformNotificationEngineLinux::isSupported() const
+bool QPlatformNotificationEngineLinux::hasCapability(const QString &capability) const
+{
+    // Until the server has answered, assume it supports everything
+    return !m_capabilitiesKnown || m_capabilities.contains(capability);
+}
+
+void QPlatformNotificationEngineLinux::beginSend(qsizetype count)
+{
+    ensureInitialized();
+
+    // The match rules must be installed before the Notify call is written,
+    // so that no signal about the new notification can be missed
+    m_sendsInFlight += count;
+    updateSignalSubscription();
+}
+
+void QPlatformNotificationEngineLinux::finishSend(uint notificationId, QDBusError::ErrorType error)
+{
+    Q_TRACE(QPlatformNotificationEngineLinux_reply, notificationId);
+    --m_sendsInFlight;
+    if (notificationId)
+        m_ownedIds.insert(notificationId);
+    updateSignalSubscription();
+
+    // A reply of any send shows that the server is answering again, even an
+    // error reply, such as for arguments the server rejects
+    if (notificationId != 0 || !isServerFailure(error)) {
+        m_consecutiveFailures = 0;
+        if (isCircuitOpen()) {
+            m_probeTimer->stop();
+            setCircuitState(QNotifications::CircuitState::Closed);
+        }
+    } else if (++m_consecutiveFailures >= CircuitFailureThreshold && !isCircuitOpen()) {
+        m_probeBackoff = InitialProbeBackoff;
+        setCircuitState(QNotifications::CircuitState::Open);
+        m_probeTimer->start(m_probeBackoff);
+    }
+}
+
+QNotifications::CircuitState QPlatformNotificationEngineLinux::circuitState() const
+{
+    return QNotifications::CircuitState(m_circuitState.loadRelaxed());
+}
+
+bool QPlatformNotificationEngineLinux::isCircuitOpen() const
+{
+    return circuitState() != QNotifications::CircuitState::Closed;
+}
+
+void QPlatformNotificationEngineLinux::setCircuitState(QNotifications::CircuitState state)
+{
+    if (m_circuitState.fetchAndStoreRelaxed(int(state)) != int(state))
+        emit circuitStateChanged(state);
+}
+
+void QPlatformNotificationEngineLinux::probeServer()
+{
+    setCircuitState(QNotifications::CircuitState::HalfOpen);
+    QDBusMessage information = QDBusMessage::createMethodCall(
+        QStringLiteral("org.freedesktop.Notifications"),
+        QStringLiteral("/org/freedesktop/Notifications"),
+        QStringLiteral("org.freedesktop.Notifications"),
+        QStringLiteral("GetServerInformation"));
+    // A probe gets no more time than a send would
+    const int timeout = defaultSendTimeout();
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(information, timeout), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        // The circuit may have closed meanwhile, through a late reply or a new server
+        if (circuitState() != QNotifications::CircuitState::HalfOpen)
+            return;
+        if (!isServerFailure(watcher->error().type())) {
+            m_consecutiveFailures = 0;
+            setCircuitState(QNotifications::CircuitState::Closed);
+            return;
+        }
+        m_probeBackoff = qMin(m_probeBackoff * 2, MaximumProbeBackoff);
+        setCircuitState(QNotifications::CircuitState::Open);
+        m_probeTimer->start(m_probeBackoff);
+    });
+}
+
+void QPlatformNotificationEngineLinux::updateSignalSubscription()
+{
+    const bool needed = m_sendsInFlight > 0 || !m_ownedIds.isEmpty();
+    if (needed && !m_signalsConnected) {
+        setSignalsConnected(true);
+    } else if (!needed && m_signalsConnected && !m_unsubscribeScheduled) {
+        // Removing the match rules is deferred to the event loop, which avoids
+        // churn when one notification closes just before the next one is sent
+        m_unsubscribeScheduled = true;
+        QMetaObject::invokeMethod(this, [this] {
+            m_unsubscribeScheduled = false;
+            if (m_sendsInFlight == 0 && m_ownedIds.isEmpty() && m_signalsConnected)
+                setSignalsConnected(false);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void QPlatformNotificationEngineLinux::setSignalsConnected(bool connected)
+{
+    // The rules name the unique bus name of the server, so that the bus does
+    // not deliver signals other peers send with the same path and interface.
+    // A well-known name would make QtDBus resolve its owner with a blocking
+    // call every time the rules are installed. Before the owner is known the
+    // rules match any sender, and the slots check the sender instead
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    const QString path = QStringLiteral("/org/freedesktop/Notifications");
+    const QString interface = QStringLiteral("org.freedesktop.Notifications");
+    if (connected) {
+        m_signalsService = m_serviceOwner;
+        bus.connect(m_signalsService, path, interface, QStringLiteral("ActionInvoked"),
+                    this, SLOT(onActionInvoked(uint,QString,QDBusMessage)));
+        bus.connect(m_signalsService, path, interface, QStringLiteral("NotificationClosed"),
+                    this, SLOT(onNotificationClosed(uint,uint,QDBusMessage)));
+    } else {
+        bus.disconnect(m_signalsService, path, interface, QStringLiteral("ActionInvoked"),
+                       this, SLOT(onActionInvoked(uint,QString,QDBusMessage)));
+        bus.disconnect(m_signalsService, path, interface, QStringLiteral("NotificationClosed"),
+                       this, SLOT(onNotificationClosed(uint,uint,QDBusMessage)));
+        m_signalsService.clear();
+    }
+    m_signalsConnected = connected;
+}
+
+void QPlatformNotificationEngineLinux::setServiceOwner(const QString &serviceOwner)
 {
-    return QDBusConnection::sessionBus().isConnected();
+    if (m_serviceOwner == serviceOwner)
+        return;
+    m_serviceOwner = serviceOwner;
+    // The rules installed for the previous server would drop the signals of
+    // the new one, and let through those of whoever got the old name
+    if (m_signalsConnected) {
+        setSignalsConnected(false);
+        setSignalsConnected(true);
+    }
 }
 
-uint QPlatformNotificationEngineLinux::sendNotification(const QString &title, const QString &message, const QVariantMap &parameters, const QMap<QString, QString> &actions)
+bool QPlatformNotificationEngineLinux::isFromServer(const QDBusMessage &message) const
 {
-    int urgency = parameters.value(QStringLiteral("urgency")).toInt();
-    QString icon = parameters.value(QStringLiteral("icon")).toString();
-    int expireTimeout = parameters.value(QStringLiteral("expire-timeout"), -1).toInt();
+    return !m_serviceOwner.isEmpty() && message.service() == m_serviceOwner;
+}
 
+void QPlatformNotificationEngineLinux::onServiceOwnerChanged(const QString &service,
+                                                             const QString &oldOwner,
+                                                             const QString &newOwner)
+{
+    Q_UNUSED(service);
+
+    setServiceOwner(newOwner);
+    m_serviceHasOwner = !newOwner.isEmpty();
+    updateAvailability();
+
+    // A new server deserves a chance of its own
+    if (!newOwner.isEmpty() && isCircuitOpen()) {
+        m_consecutiveFailures = 0;
+        m_probeTimer->stop();
+        setCircuitState(QNotifications::CircuitState::Closed);
+    }
+
+    const bool wasKnown = m_capabilitiesKnown;
+    {
+        QMutexLocker locker(&m_capabilitiesMutex);
+        m_capabilities.clear();
+    }
+    m_capabilitiesKnown = false;
+    ++m_capabilitiesGeneration;
+    if (wasKnown)
+        emit capabilitiesChanged();
+    if (!newOwner.isEmpty())
+        fetchCapabilities();
+
+    if (!newOwner.isEmpty())
+        emit serverIdentityChanged(linuxServerIdentity(newOwner));
+
+    // Notifications of the previous server are gone with it, and its IDs may
+    // belong to other applications on the new one. A server that was just
+    // started, possibly by our own Notify call, has only ours
+    if (!oldOwner.isEmpty()) {
+        m_ownedIds.clear();
+        clearNotificationOwners();
+        updateSignalSubscription();
+    }
+}
+
+QFuture<uint> QPlatformNotificationEngineLinux::notificationIdFuture(const QDBusPendingCall &call)
+{
+    auto promise = std::make_shared<QPromise<uint>>();
+    QFuture<uint> future = promise->future();
+    promise->start();
+
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, promise](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<uint> reply = *watcher;
+        const uint notificationId = reply.isValid() ? reply.value() : 0u;
+        finishSend(notificationId, reply.error().type());
+        promise->addResult(notificationId);
+        promise->finish();
+        watcher->deleteLater();
+    });
+    return future;
+}
+
+QDBusMessage QPlatformNotificationEngineLinux::createNotifyMessage(const QNotificationRequest &request,
+                                                                  uint replacesId)
+{
+    Q_TRACE(QPlatformNotificationEngineLinux_marshal_entry, replacesId);
     QDBusMessage msg = QDBusMessage::createMethodCall(
         QStringLiteral("org.freedesktop.Notifications"),
         QStringLiteral("/org/freedesktop/Notifications"),
         QStringLiteral("org.freedesktop.Notifications"),
         QStringLiteral("Notify"));
 
-    QList<QVariant> args;
+    // Add default action to make notification clickable, followed by
+    // the user-defined actions, which are already stored as key/label pairs.
+    // Servers without the "actions" capability would ignore them
     QStringList actionList;
+    if (hasCapability(QStringLiteral("actions"))) {
+        actionList = request.actions();
+        actionList.prepend(QString());
+        actionList.prepend(QStringLiteral("default"));
+    }
 
-    // Add default action to make notification clickable
-    actionList << QStringLiteral("default") << QStringLiteral("");
+    QVariantMap map = request.hints();
+    map.insert(QStringLiteral("urgency"), int(request.urgency()));
+    if (!request.category().isEmpty())
+        map.insert(QStringLiteral("category"), request.category());
 
-    // Add user-defined actions
-    for (auto it = actions.constBegin(); it != actions.constEnd(); ++it)
-        actionList << it.key() << it.value();
+    // Servers that cannot show images do not get the pixel data either
+    const bool imagesSupported = hasCapability(QStringLiteral("icon-static"))
+            || hasCapability(QStringLiteral("icon-multi"));
+    if (!imagesSupported) {
+        map.remove(QStringLiteral("image-data"));
+        map.remove(QStringLiteral("image_data"));
+        map.remove(QStringLiteral("image-path"));
+        map.remove(QStringLiteral("image_path"));
+        map.remove(QStringLiteral("icon_data"));
+    }
 
-    QVariantMap map;
-    map.insert(QStringLiteral("urgency"), urgency);
+    QString message;
+    if (hasCapability(QStringLiteral("body"))) {
+        message = request.message();
+        // Servers without markup support would show the tags literally
+        if (!hasCapability(QStringLiteral("body-markup"))
+                && (message.contains(QLatin1Char('<')) || message.contains(QLatin1Char('&')))) {
+            message = plainTextFromMarkup(message);
+        }
+    }
 
-    // Handle image-data structure (iiibiiay)
-    QVariant imageDataParam = parameters.value(QStringLiteral("image-data"));
-    if (imageDataParam.isValid()) {
-        if (imageDataParam.typeId() == QMetaType::QVariantMap) {
-            // Build DBus structure (iiibiiay) from QVariantMap
-            QVariantMap imageDataMap = imageDataParam.toMap();
-            QDBusArgument imageDataArg;
-            imageDataArg.beginStructure();
-            imageDataArg << imageDataMap.value(QStringLiteral("width")).toInt();
-            imageDataArg << imageDataMap.value(QStringLiteral("height")).toInt();
-            imageDataArg << imageDataMap.value(QStringLiteral("rowstride")).toInt();
-            imageDataArg << imageDataMap.value(QStringLiteral("has_alpha")).toBool();
-            imageDataArg << imageDataMap.value(QStringLiteral("bits_per_sample")).toInt();
-            imageDataArg << imageDataMap.value(QStringLiteral("channels")).toInt();
-            imageDataArg << imageDataMap.value(QStringLiteral("data")).toByteArray();
-            imageDataArg.endStructure();
-            map.insert(QStringLiteral("image-data"), QVariant::fromValue(imageDataArg));
+    // The path-based image hints also take a QImage, which is passed as the
+    // path of its entry in the icon cache; the server reads the file itself
+    QImage image = request.image();
+    for (const QString &key : { QStringLiteral("image-path"), QStringLiteral("image_path") }) {
+        const auto hint = map.find(key);
+        if (hint == map.end() || hint->typeId() != QMetaType::QImage)
+            continue;
+        const QImage hintImage = hint->value<QImage>();
+        const QString path = QNotificationIconCache::instance()->pathForImage(hintImage);
+        if (!path.isEmpty()) {
+            *hint = QUrl::fromLocalFile(path).toString();
+        } else {
+            // Without a usable cache, the image is sent inline instead
+            map.erase(hint);
+            if (image.isNull())
+                image = hintImage;
         }
     }
 
-    args << QStringLiteral("qtnotifications")
-         << uint(0)
-         << icon
-         << title
-         << message
-         << QVariant::fromValue(actionList)
-         << map
-         << expireTimeout;
+    // Handle image-data structure (iiibiiay)
+    const auto imageDataParam = map.constFind(QStringLiteral("image-data"));
+    if (imagesSupported && !image.isNull()) {
+        map.insert(QStringLiteral("image-data"), QVariant::fromValue(dbusImage(image)));
+    } else if (imageDataParam != map.cend() && imageDataParam->typeId() == QMetaType::QVariantMap) {
+        // Build DBus structure (iiibiiay) from QVariantMap
+        const QVariantMap imageDataMap = imageDataParam->toMap();
+        QDBusArgument imageDataArg;
+        imageDataArg.beginStructure();
+        imageDataArg << imageDataMap.value(QStringLiteral("width")).toInt();
+        imageDataArg << imageDataMap.value(QStringLiteral("height")).toInt();
+        imageDataArg << imageDataMap.value(QStringLiteral("rowstride")).toInt();
+        imageDataArg << imageDataMap.value(QStringLiteral("has_alpha")).toBool();
+        imageDataArg << imageDataMap.value(QStringLiteral("bits_per_sample")).toInt();
+        imageDataArg << imageDataMap.value(QStringLiteral("channels")).toInt();
+        imageDataArg << imageDataMap.value(QStringLiteral("data")).toByteArray();
+        imageDataArg.endStructure();
+        map.insert(QStringLiteral("image-data"), QVariant::fromValue(imageDataArg));
+    }
 
-    msg.setArguments(args);
-    QDBusMessage reply = QDBusConnection::sessionBus().call(msg);
-    if (reply.type() == QDBusMessage::ReplyMessage && !reply.arguments().isEmpty())
-        return reply.arguments().first().toUInt();
-    return 0;
+    const QString appName = QStringLiteral("qtnotifications");
+    const QString icon = request.icon();
+    const QString title = request.title();
+
+    // The size is counted from the values at hand rather than from the
+    // arguments of the message, which would have to be copied and unwrapped
+    qint64 size = marshalledSize(appName) + 4 + marshalledSize(icon) + marshalledSize(title)
+            + marshalledSize(message) + 4 + 4 + 4;
+    for (const QString &action : std::as_const(actionList))
+        size += marshalledSize(action);
+    for (auto it = map.cbegin(); it != map.cend(); ++it)
+        size += marshalledSize(it.key()) + 3 + marshalledHintSize(it.value());
+    recordBytesMarshalled(size);
+
+    msg.setArguments({
+        appName,
+        replacesId,
+        icon,
+        title,
+        message,
+        QVariant::fromValue(actionList),
+        map,
+        request.expireTimeout()
+    });
+    Q_TRACE(QPlatformNotificationEngineLinux_marshal_exit, size);
+    return msg;
 }
 
-void QPlatformNotificationEngineLinux::onActionInvoked(uint id, const QString &actionKey)
+void QPlatformNotificationEngineLinux::onActionInvoked(uint id, const QString &actionKey,
+                                                       const QDBusMessage &message)
 {
+    Q_TRACE(QPlatformNotificationEngineLinux_onActionInvoked, id, actionKey);
+    // Any peer can emit a signal with this path and interface
+    if (!isFromServer(message) || !m_ownedIds.contains(id)) {
+        recordDroppedSignal();
+        return;
+    }
+
     // Check if this is a notification click (default action) vs a specific action button
     if (actionKey == QStringLiteral("default")) {
         emit notificationClicked(id);
@@ -100,8 +895,15 @@ void QPlatformNotificationEngineLinux::onActionInvoked(uint id, const QString &a
     }
 }
 
-void QPlatformNotificationEngineLinux::onNotificationClosed(uint id, uint reason)
+void QPlatformNotificationEngineLinux::onNotificationClosed(uint id, uint reason,
+                                                            const QDBusMessage &message)
 {
+    Q_TRACE(QPlatformNotificationEngineLinux_onNotificationClosed, id, reason);
+    if (!isFromServer(message) || !m_ownedIds.remove(id)) {
+        recordDroppedSignal();
+        return;
+    }
+
     QNotifications::ClosedReason closedReason;
     switch (reason) {
         case 1:
@@ -118,12 +920,48 @@ void QPlatformNotificationEngineLinux::onNotificationClosed(uint id, uint reason
             break;
     }
     emit notificationClosed(id, closedReason);
+    updateSignalSubscription();
 }
 
+namespace {
+
+struct QNotificationEngineLinuxHolder
+{
+    QNotificationEngineLinuxHolder()
+        : engine(new QPlatformNotificationEngineLinux)
+    {
+        // Message construction, image marshalling and reply handling can be moved
+        // off the threads that send notifications, typically the GUI thread
+        if (QNotifications::isEngineThreadEnabled()) {
+            thread.setObjectName(QStringLiteral("QtNotifications D-Bus"));
+            engine->moveToThread(&thread);
+            thread.start();
+        }
+    }
+
+    ~QNotificationEngineLinuxHolder()
+    {
+        if (!thread.isRunning()) {
+            delete engine;
+            return;
+        }
+        // The engine, its timers and its D-Bus watchers are destroyed on their
+        // own thread, which processes the deletion before it finishes
+        engine->deleteLater();
+        thread.quit();
+        thread.wait();
+    }
+
+    QThread thread;
+    QPlatformNotificationEngineLinux *engine;
+};
+
+} // namespace
+
 QPlatformNotificationEngine *qt_create_notification_engine_linux()
 {
-    static QPlatformNotificationEngineLinux engine;
-    return &engine;
+    static QNotificationEngineLinuxHolder holder;
+    return holder.engine;
 }
 
 QT_END_NAMESPACE
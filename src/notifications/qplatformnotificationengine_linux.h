@@ -2,9 +2,20 @@
 #define QPLATFORMNOTIFICATIONENGINE_LINUX_H
 
 #include <QtNotifications/qplatformnotificationengine.h>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QTimer>
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QPromise>
+#include <QtCore/QSet>
+#include <QtDBus/QDBusError>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCall>
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -16,14 +27,95 @@ public:
     ~QPlatformNotificationEngineLinux() = default;
 
     bool isSupported() const override;
-    uint sendNotification(const QString &title,
-                         const QString &message,
-                         const QVariantMap &parameters,
-                         const QMap<QString, QString> &actions) override;
+    uint sendNotification(const QNotificationRequest &request) override;
+    QFuture<uint> sendNotificationAsync(const QNotificationRequest &request) override;
+    QFuture<QList<uint>> sendNotifications(const QList<QNotificationRequest> &requests) override;
+    bool sendNotificationNoReply(const QNotificationRequest &request) override;
+    QFuture<uint> updateNotification(uint notificationId, const QNotificationRequest &request) override;
+    void closeNotification(uint notificationId) override;
+    void closeNotifications(const QList<uint> &notificationIds) override;
+    QStringList capabilities() const override;
+    bool isAvailable() const override;
+    void prewarm() override;
+    void adoptNotifications(const QList<uint> &notificationIds) override;
+    QNotifications::CircuitState circuitState() const override;
+    QString serverIdentity() const override;
+
+private:
+    bool isEngineThread() const;
+    void ensureInitialized();
+    void updateAvailability();
+
+    // Updates of one notification: at most one Notify call is in flight, and
+    // only the latest request made meanwhile is kept for the next one
+    struct UpdateQueue
+    {
+        QNotificationRequest nextRequest;
+        QList<std::shared_ptr<QPromise<uint>>> nextPromises;
+    };
+
+    QDBusMessage createNotifyMessage(const QNotificationRequest &request, uint replacesId = 0);
+    void dispatchUpdate(uint notificationId, uint replacesId, const QNotificationRequest &request,
+                        const QList<std::shared_ptr<QPromise<uint>>> &promises);
+    QFuture<uint> notificationIdFuture(const QDBusPendingCall &call);
+    void fetchCapabilities();
+    bool hasCapability(const QString &capability) const;
+    void beginSend(qsizetype count = 1);
+    void finishSend(uint notificationId, QDBusError::ErrorType error = QDBusError::NoError);
+    void updateSignalSubscription();
+    void setSignalsConnected(bool connected);
+    void setServiceOwner(const QString &serviceOwner);
+    bool isFromServer(const QDBusMessage &message) const;
+    bool isCircuitOpen() const;
+    void setCircuitState(QNotifications::CircuitState state);
+    void probeServer();
+
+    // The bus is first touched from the event loop, or by the first send,
+    // never from the constructor
+    bool m_initialized = false;
+    bool m_prewarmed = false;
+    // -1 while unknown, otherwise whether the session bus is connected
+    QAtomicInteger<int> m_busConnected = -1;
+    QAtomicInteger<bool> m_available = true;
+    bool m_serviceHasOwner = false;
+    // Unique bus name of the running server, empty while it is not known
+    QString m_serviceOwner;
+    bool m_serviceActivatable = false;
+    int m_availabilityQueriesPending = 0;
+
+    // Written on the engine thread only; the lock is for capabilities()
+    mutable QMutex m_capabilitiesMutex;
+    QStringList m_capabilities;
+    bool m_capabilitiesKnown = false;
+    // Incremented whenever the cached capabilities become stale, so that
+    // replies meant for a previous server are ignored
+    quint64 m_capabilitiesGeneration = 0;
+    // Chains of updates, by the ID the first update of a chain was made with
+    QHash<uint, UpdateQueue> m_updates;
+    // Chain of every ID the server assigned to an update while its chain goes on
+    QHash<uint, uint> m_updateAliases;
+
+    // IDs of the notifications sent by this process that are still shown; signals
+    // about any other notification are dropped. The match rules for those signals
+    // are only installed while a send is in flight or a notification is owned
+    QSet<uint> m_ownedIds;
+    qsizetype m_sendsInFlight = 0;
+    bool m_signalsConnected = false;
+    // Sender the installed match rules are restricted to
+    QString m_signalsService;
+    bool m_unsubscribeScheduled = false;
+
+    // Circuit breaker for a server that stopped answering: written on the
+    // engine thread, read from any thread
+    QAtomicInteger<int> m_circuitState = int(QNotifications::CircuitState::Closed);
+    int m_consecutiveFailures = 0;
+    int m_probeBackoff = 0;
+    QTimer *m_probeTimer = nullptr;
 
 private Q_SLOTS:
-    void onActionInvoked(uint id, const QString &actionKey);
-    void onNotificationClosed(uint id, uint reason);
+    void onServiceOwnerChanged(const QString &service, const QString &oldOwner, const QString &newOwner);
+    void onActionInvoked(uint id, const QString &actionKey, const QDBusMessage &message);
+    void onNotificationClosed(uint id, uint reason, const QDBusMessage &message);
 };
 
 QPlatformNotificationEngine *qt_create_notification_engine_linux();
@@ -0,0 +1,177 @@
+#include "qplatformnotificationengine_loopback_p.h"
+
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+QPlatformNotificationEngineLoopback::QPlatformNotificationEngineLoopback(QObject *parent)
+  : QPlatformNotificationEngine(parent)
+{
+}
+
+QPlatformNotificationEngineLoopback *QPlatformNotificationEngineLoopback::instance()
+{
+    return static_cast<QPlatformNotificationEngineLoopback *>(qt_create_notification_engine_loopback());
+}
+
+bool QPlatformNotificationEngineLoopback::isSupported() const
+{
+    return true;
+}
+
+uint QPlatformNotificationEngineLoopback::sendNotification(const QNotificationRequest &request)
+{
+    Q_UNUSED(request)
+    if (m_failing.loadRelaxed())
+        return 0;
+    m_sentCount.fetchAndAddRelaxed(1);
+    // Skip 0 on wrap-around, it means "not sent" throughout the API
+    uint id = m_lastId.fetchAndAddRelaxed(1) + 1;
+    if (id == 0)
+        id = m_lastId.fetchAndAddRelaxed(1) + 1;
+    QMutexLocker locker(&m_openIdsMutex);
+    m_openIds.insert(id);
+    return id;
+}
+
+QFuture<uint> QPlatformNotificationEngineLoopback::sendNotificationAsync(const QNotificationRequest &request)
+{
+    if (!m_repliesHeld.loadRelaxed())
+        return QtFuture::makeReadyValueFuture(sendNotification(request));
+
+    auto promise = std::make_shared<QPromise<uint>>();
+    QFuture<uint> future = promise->future();
+    promise->start();
+    const uint notificationId = sendNotification(request);
+    QMutexLocker locker(&m_heldRepliesMutex);
+    m_heldReplies.append({ notificationId, std::move(promise) });
+    return future;
+}
+
+QFuture<QList<uint>> QPlatformNotificationEngineLoopback::sendNotifications(const QList<QNotificationRequest> &requests)
+{
+    QList<uint> ids;
+    ids.reserve(requests.size());
+    for (const QNotificationRequest &request : requests)
+        ids.append(sendNotification(request));
+    return QtFuture::makeReadyValueFuture(std::move(ids));
+}
+
+bool QPlatformNotificationEngineLoopback::sendNotificationNoReply(const QNotificationRequest &request)
+{
+    Q_UNUSED(request)
+    if (m_failing.loadRelaxed())
+        return false;
+    m_sentCount.fetchAndAddRelaxed(1);
+    return true;
+}
+
+QFuture<uint> QPlatformNotificationEngineLoopback::updateNotification(uint notificationId,
+                                                                      const QNotificationRequest &request)
+{
+    if (notificationId == 0 || m_failing.loadRelaxed())
+        return QtFuture::makeReadyValueFuture(sendNotification(request));
+    if (m_renumberingUpdates.loadRelaxed()) {
+        forgetId(notificationId);
+        return QtFuture::makeReadyValueFuture(sendNotification(request));
+    }
+    m_sentCount.fetchAndAddRelaxed(1);
+    return QtFuture::makeReadyValueFuture(notificationId);
+}
+
+void QPlatformNotificationEngineLoopback::closeNotification(uint notificationId)
+{
+    if (forgetId(notificationId))
+        emit notificationClosed(notificationId, QNotifications::Closed);
+}
+
+// Changes with every simulated server restart, as the identity of a real
+// server does when it is replaced
+QString QPlatformNotificationEngineLoopback::serverIdentity() const
+{
+    return QStringLiteral("loopback-%1").arg(m_serverGeneration.loadRelaxed());
+}
+
+quint64 QPlatformNotificationEngineLoopback::sentCount() const
+{
+    return m_sentCount.loadRelaxed();
+}
+
+void QPlatformNotificationEngineLoopback::setFailing(bool failing)
+{
+    m_failing.storeRelaxed(failing);
+}
+
+bool QPlatformNotificationEngineLoopback::isFailing() const
+{
+    return m_failing.loadRelaxed();
+}
+
+void QPlatformNotificationEngineLoopback::setRenumberingUpdates(bool renumbering)
+{
+    m_renumberingUpdates.storeRelaxed(renumbering);
+}
+
+void QPlatformNotificationEngineLoopback::setRepliesHeld(bool held)
+{
+    m_repliesHeld.storeRelaxed(held);
+}
+
+void QPlatformNotificationEngineLoopback::releaseReplies()
+{
+    QList<HeldReply> replies;
+    {
+        QMutexLocker locker(&m_heldRepliesMutex);
+        replies = std::exchange(m_heldReplies, {});
+    }
+    // Continuations may send again, and have their replies held or not
+    for (const HeldReply &reply : std::as_const(replies)) {
+        reply.promise->addResult(reply.notificationId);
+        reply.promise->finish();
+    }
+}
+
+bool QPlatformNotificationEngineLoopback::forgetId(uint notificationId)
+{
+    QMutexLocker locker(&m_openIdsMutex);
+    return m_openIds.remove(notificationId);
+}
+
+void QPlatformNotificationEngineLoopback::simulateClick(uint notificationId)
+{
+    forgetId(notificationId);
+    emit notificationClicked(notificationId);
+    emit notificationClosed(notificationId, QNotifications::Closed);
+}
+
+void QPlatformNotificationEngineLoopback::simulateAction(uint notificationId, const QString &actionKey)
+{
+    forgetId(notificationId);
+    emit actionInvoked(notificationId, actionKey);
+    emit notificationClosed(notificationId, QNotifications::Closed);
+}
+
+void QPlatformNotificationEngineLoopback::simulateClose(uint notificationId, QNotifications::ClosedReason reason)
+{
+    forgetId(notificationId);
+    emit notificationClosed(notificationId, reason);
+}
+
+void QPlatformNotificationEngineLoopback::simulateServerRestart()
+{
+    {
+        QMutexLocker locker(&m_openIdsMutex);
+        m_openIds.clear();
+    }
+    clearNotificationOwners();
+    m_serverGeneration.fetchAndAddRelaxed(1);
+    emit serverIdentityChanged(serverIdentity());
+}
+
+QPlatformNotificationEngine *qt_create_notification_engine_loopback()
+{
+    static QPlatformNotificationEngineLoopback engine;
+    return &engine;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,100 @@
+#ifndef QPLATFORMNOTIFICATIONENGINE_LOOPBACK_P_H
+#define QPLATFORMNOTIFICATIONENGINE_LOOPBACK_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNotifications/qplatformnotificationengine.h>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPromise>
+#include <QtCore/QSet>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class Q_NOTIFICATIONS_EXPORT QPlatformNotificationEngineLoopback : public QPlatformNotificationEngine
+{
+    Q_OBJECT
+public:
+    explicit QPlatformNotificationEngineLoopback(QObject *parent = nullptr);
+    ~QPlatformNotificationEngineLoopback() = default;
+
+    static QPlatformNotificationEngineLoopback *instance();
+
+    bool isSupported() const override;
+    uint sendNotification(const QNotificationRequest &request) override;
+    QFuture<uint> sendNotificationAsync(const QNotificationRequest &request) override;
+    QFuture<QList<uint>> sendNotifications(const QList<QNotificationRequest> &requests) override;
+    bool sendNotificationNoReply(const QNotificationRequest &request) override;
+    QFuture<uint> updateNotification(uint notificationId, const QNotificationRequest &request) override;
+    void closeNotification(uint notificationId) override;
+    QString serverIdentity() const override;
+
+    quint64 sentCount() const;
+
+    // Test API: the functions below script the behavior of a notification
+    // server for the auto tests of Qt Notifications. They affect every
+    // QNotifications that uses the loopback engine.
+
+    // While failing, every send and update is rejected as by an unreachable server
+    void setFailing(bool failing);
+    bool isFailing() const;
+
+    // While renumbering, updates are shown as new notifications with new IDs,
+    // as by a server that no longer knows the updated one
+    void setRenumberingUpdates(bool renumbering);
+
+    // While held, sendNotificationAsync() replies only once releaseReplies() is
+    // called, as a server would after a round trip
+    void setRepliesHeld(bool held);
+    void releaseReplies();
+
+public Q_SLOTS:
+    void simulateClick(uint notificationId);
+    void simulateAction(uint notificationId, const QString &actionKey);
+    void simulateClose(uint notificationId, QNotifications::ClosedReason reason = QNotifications::Dismissed);
+    // The notifications shown are gone, and new IDs come from another server
+    void simulateServerRestart();
+
+private:
+    bool forgetId(uint notificationId);
+
+    QAtomicInteger<uint> m_lastId;
+    QAtomicInteger<quint64> m_sentCount;
+    QAtomicInteger<bool> m_failing;
+    QAtomicInteger<bool> m_renumberingUpdates;
+    QAtomicInteger<bool> m_repliesHeld;
+    QAtomicInteger<int> m_serverGeneration;
+
+    // IDs issued and not closed yet; closing any other ID does nothing, as
+    // with a server
+    QMutex m_openIdsMutex;
+    QSet<uint> m_openIds;
+
+    struct HeldReply
+    {
+        uint notificationId = 0;
+        std::shared_ptr<QPromise<uint>> promise;
+    };
+    QMutex m_heldRepliesMutex;
+    QList<HeldReply> m_heldReplies;
+};
+
+QPlatformNotificationEngine *qt_create_notification_engine_loopback();
+
+QT_END_NAMESPACE
+
+#endif // QPLATFORMNOTIFICATIONENGINE_LOOPBACK_P_H
@@ -1,4 +1,5 @@
 #include "qplatformnotificationengine_windows.h"
+#include "qnotificationiconcache_p.h"
 #include <windows.h>
 #include <shobjidl.h>
 #include <winrt/Windows.Data.Xml.Dom.h>
@@ -57,11 +58,15 @@ bool QPlatformNotificationEngineWindows::isSupported() const
     return osvi.dwMajorVersion >= 10;
 }
 
-uint QPlatformNotificationEngineWindows::sendNotification(const QString &title, const QString &message, const QVariantMap &parameters, const QMap<QString, QString> &actions)
+uint QPlatformNotificationEngineWindows::sendNotification(const QNotificationRequest &request)
 {
+    const QVariantMap parameters = request.hints();
     QString appLogoOverride = parameters.value(QStringLiteral("appLogoOverride")).toString();
     QString heroImage = parameters.value(QStringLiteral("hero")).toString();
     QString inlineImage = parameters.value(QStringLiteral("inline")).toString();
+    // Toasts reference images by path, so a request image goes through the icon cache
+    if (appLogoOverride.isEmpty() && !request.image().isNull())
+        appLogoOverride = QNotificationIconCache::instance()->pathForImage(request.image());
 
     ensureComInitialized();
     static uint s_notificationId = 1;
@@ -93,11 +98,12 @@ uint QPlatformNotificationEngineWindows::sendNotification(const QString &title,
         "<text>%2</text>"
         "</binding>"
         "</visual>"
-    ).arg(title, message);
+    ).arg(request.title(), request.message());
+    const QStringList actions = request.actions();
     if (!actions.isEmpty()) {
         xml += QStringLiteral("<actions>");
-        for (auto it = actions.constBegin(); it != actions.constEnd(); ++it) {
-            xml += QStringLiteral("<action content=\"%1\" arguments=\"%2\" activationType=\"foreground\"/>").arg(it.value(), it.key());
+        for (qsizetype i = 0; i + 1 < actions.size(); i += 2) {
+            xml += QStringLiteral("<action content=\"%1\" arguments=\"%2\" activationType=\"foreground\"/>").arg(actions.at(i + 1), actions.at(i));
         }
         xml += QStringLiteral("</actions>");
     }
@@ -107,6 +113,9 @@ uint QPlatformNotificationEngineWindows::sendNotification(const QString &title,
         auto toastXml = winrt::Windows::Data::Xml::Dom::XmlDocument();
         toastXml.LoadXml(winrt::hstring(xml.toStdWString()));
         auto toast = winrt::Windows::UI::Notifications::ToastNotification(toastXml);
+        // Tag and group identify the toast in the notification history, for closeNotification()
+        toast.Tag(winrt::to_hstring(notificationId));
+        toast.Group(L"qtnotifications");
         // Use TypedEventHandler for event handlers
         using ActivatedHandler = winrt::Windows::Foundation::TypedEventHandler<winrt::Windows::UI::Notifications::ToastNotification, winrt::Windows::Foundation::IInspectable>;
         using DismissedHandler = winrt::Windows::Foundation::TypedEventHandler<winrt::Windows::UI::Notifications::ToastNotification, winrt::Windows::UI::Notifications::ToastDismissedEventArgs>;
@@ -123,6 +132,31 @@ uint QPlatformNotificationEngineWindows::sendNotification(const QString &title,
     }
 }
 
+void QPlatformNotificationEngineWindows::closeNotification(uint notificationId)
+{
+    if (notificationId == 0)
+        return;
+
+    ensureComInitialized();
+    const void *toastPtr = m_notificationIdMap.key(notificationId, nullptr);
+    try {
+        // Removing the toast from the history also hides it if it is still shown
+        ToastNotificationManager::History().Remove(winrt::to_hstring(notificationId), L"qtnotifications",
+                                                   winrt::hstring(m_appUserModelID.toStdWString()));
+    } catch (const winrt::hresult_error &e) {
+        qWarning() << "WinRT error:" << QString::fromWCharArray(e.message().c_str());
+        return;
+    }
+
+    // A toast that is still shown reports that it was hidden through its
+    // Dismissed event, so only toasts not shown by this process are reported
+    // here, such as those of an earlier run
+    if (m_expiredIds.remove(notificationId))
+        m_notificationIdMap.remove(toastPtr);
+    else if (!toastPtr)
+        emit notificationClosed(notificationId, QNotifications::Closed);
+}
+
 void QPlatformNotificationEngineWindows::ensureComInitialized() const
 {
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
@@ -209,6 +243,7 @@ void QPlatformNotificationEngineWindows::onToastActivated(winrt::Windows::UI::No
 
     // Remove from map after handling
     m_notificationIdMap.remove(toastPtr);
+    m_expiredIds.remove(notificationId);
 }
 
 void QPlatformNotificationEngineWindows::onToastDismissed(winrt::Windows::UI::Notifications::ToastNotification const& sender, winrt::Windows::UI::Notifications::ToastDismissedEventArgs const& args)
@@ -224,6 +259,7 @@ void QPlatformNotificationEngineWindows::onToastDismissed(winrt::Windows::UI::No
             break;
         case winrt::Windows::UI::Notifications::ToastDismissalReason::TimedOut:
             emit notificationClosed(notificationId, QNotifications::Expired);
+            m_expiredIds.insert(notificationId);
             return; // toasts can be expired even when they are still available from the notification center
         case winrt::Windows::UI::Notifications::ToastDismissalReason::UserCanceled:
             emit notificationClosed(notificationId, QNotifications::Dismissed);
@@ -5,6 +5,7 @@
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <windows.h>
 #include <winrt/Windows.Data.Xml.Dom.h>
 #include <winrt/Windows.UI.Notifications.h>
@@ -19,10 +20,8 @@ public:
     ~QPlatformNotificationEngineWindows() = default;
 
     bool isSupported() const override;
-    uint sendNotification(const QString &title,
-                         const QString &message,
-                         const QVariantMap &parameters,
-                         const QMap<QString, QString> &actions) override;
+    uint sendNotification(const QNotificationRequest &request) override;
+    void closeNotification(uint notificationId) override;
 
 private:
     void ensureComInitialized() const;
@@ -35,6 +34,9 @@ private:
     QString m_appUserModelID;
     // Map from ToastNotification pointer to notification ID
     QHash<const void*, uint> m_notificationIdMap;
+    // Toasts that timed out and are kept in the notification center; they were
+    // reported closed already
+    QSet<uint> m_expiredIds;
 };
 
 QPlatformNotificationEngine *qt_create_notification_engine_windows();
@@ -0,0 +1,162 @@
+#include <QtTest/QtTest>
+#include <QtCore/QAbstractItemModel>
+#include <QtQml/QQmlComponent>
+#include <QtQml/QQmlEngine>
+#include <QtNotifications/private/qplatformnotificationengine_loopback_p.h>
+
+#include <memory>
+
+using namespace Qt::StringLiterals;
+
+// Lists the notifications of a Notifications object that sends them to the
+// loopback engine, whose events are simulated.
+class tst_QDeclarativeNotificationsModel : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void postedAndClosed();
+    void keepClosed();
+    void clickedAndActions();
+
+private:
+    uint send(const QString &title, const QString &message);
+    int role(const QByteArray &name) const;
+    QVariant data(int row, const QByteArray &roleName) const;
+    int rowOf(uint notificationId) const;
+
+    QQmlEngine *m_engine = nullptr;
+    std::unique_ptr<QObject> m_root;
+    QObject *m_notifications = nullptr;
+    QAbstractItemModel *m_model = nullptr;
+};
+
+void tst_QDeclarativeNotificationsModel::initTestCase()
+{
+    // Read when the Notifications object creates its QNotifications
+    qputenv("QT_NOTIFICATIONS_ENGINE", "loopback");
+    m_engine = new QQmlEngine(this);
+}
+
+void tst_QDeclarativeNotificationsModel::init()
+{
+    QQmlComponent component(m_engine);
+    component.setData(R"(
+        import QtQml
+        import QtNotifications
+
+        QtObject {
+            id: root
+            property Notifications notifications: Notifications {}
+            property NotificationsModel model: NotificationsModel {
+                notifications: root.notifications
+            }
+        }
+    )"_ba, QUrl());
+    m_root.reset(component.create());
+    QVERIFY2(m_root, qPrintable(component.errorString()));
+    m_notifications = m_root->property("notifications").value<QObject *>();
+    m_model = qobject_cast<QAbstractItemModel *>(m_root->property("model").value<QObject *>());
+    QVERIFY(m_notifications);
+    QVERIFY(m_model);
+}
+
+void tst_QDeclarativeNotificationsModel::cleanup()
+{
+    m_root.reset();
+    m_notifications = nullptr;
+    m_model = nullptr;
+}
+
+uint tst_QDeclarativeNotificationsModel::send(const QString &title, const QString &message)
+{
+    uint notificationId = 0;
+    QMetaObject::invokeMethod(m_notifications, "sendNotification", Q_RETURN_ARG(uint, notificationId),
+                              Q_ARG(QString, title), Q_ARG(QString, message));
+    return notificationId;
+}
+
+int tst_QDeclarativeNotificationsModel::role(const QByteArray &name) const
+{
+    return m_model->roleNames().key(name, -1);
+}
+
+QVariant tst_QDeclarativeNotificationsModel::data(int row, const QByteArray &roleName) const
+{
+    return m_model->data(m_model->index(row, 0), role(roleName));
+}
+
+int tst_QDeclarativeNotificationsModel::rowOf(uint notificationId) const
+{
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        if (data(row, "notificationId").toUInt() == notificationId)
+            return row;
+    }
+    return -1;
+}
+
+void tst_QDeclarativeNotificationsModel::postedAndClosed()
+{
+    QSignalSpy inserted(m_model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(m_model, &QAbstractItemModel::rowsRemoved);
+
+    const uint first = send(u"First"_s, u"One"_s);
+    const uint second = send(u"Second"_s, u"Two"_s);
+    QVERIFY(first != 0);
+    QVERIFY(second != 0);
+    QTRY_COMPARE(m_model->rowCount(), 2);
+    QCOMPARE(inserted.size(), 2);
+
+    // Rows are in the order the notifications were sent
+    QCOMPARE(data(0, "title").toString(), u"First"_s);
+    QCOMPARE(data(0, "message").toString(), u"One"_s);
+    QCOMPARE(data(0, "notificationId").toUInt(), first);
+    QCOMPARE(data(1, "title").toString(), u"Second"_s);
+    QCOMPARE(data(1, "notificationId").toUInt(), second);
+
+    // Closing a notification removes its row only
+    QPlatformNotificationEngineLoopback::instance()->simulateClose(first);
+    QTRY_COMPARE(m_model->rowCount(), 1);
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(data(0, "notificationId").toUInt(), second);
+}
+
+void tst_QDeclarativeNotificationsModel::keepClosed()
+{
+    QVERIFY(m_model->setProperty("keepClosed", true));
+    const uint notificationId = send(u"Kept"_s, u"Message"_s);
+    QVERIFY(notificationId != 0);
+    QTRY_COMPARE(m_model->rowCount(), 1);
+
+    QPlatformNotificationEngineLoopback::instance()->simulateClose(notificationId, QNotifications::Expired);
+    QTRY_COMPARE(data(0, "closedReason").toInt(), int(QNotifications::Expired));
+    QCOMPARE(m_model->rowCount(), 1);
+    QVERIFY(data(0, "closedAt").toDateTime().isValid());
+
+    QMetaObject::invokeMethod(m_model, "removeClosed");
+    QCOMPARE(m_model->rowCount(), 0);
+}
+
+void tst_QDeclarativeNotificationsModel::clickedAndActions()
+{
+    QVERIFY(m_model->setProperty("keepClosed", true));
+    const uint clicked = send(u"Clicked"_s, u"Message"_s);
+    const uint acted = send(u"Acted"_s, u"Message"_s);
+    QTRY_COMPARE(m_model->rowCount(), 2);
+
+    QPlatformNotificationEngineLoopback::instance()->simulateAction(acted, u"reply"_s);
+    QTRY_COMPARE(data(rowOf(acted), "invokedAction").toString(), u"reply"_s);
+
+    QSignalSpy changed(m_model, &QAbstractItemModel::dataChanged);
+    QPlatformNotificationEngineLoopback::instance()->simulateClick(clicked);
+    QTRY_VERIFY(!changed.isEmpty());
+    QCOMPARE(rowOf(clicked), 0);
+}
+
+QTEST_GUILESS_MAIN(tst_QDeclarativeNotificationsModel)
+
+#include "tst_qdeclarativenotificationsmodel.moc"
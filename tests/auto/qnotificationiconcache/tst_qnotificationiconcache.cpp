@@ -0,0 +1,167 @@
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include <QtGui/QImage>
+#include <QtNotifications/private/qnotificationiconcache_p.h>
+
+#include <memory>
+#include <utility>
+
+using namespace Qt::StringLiterals;
+
+class tst_QNotificationIconCache : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+
+    void hit();
+    void rewriteRemoved();
+    void eviction();
+    void restart();
+    void untrustedDirectory();
+
+private:
+    static QImage image(QRgb color);
+    static bool appendMarker(const QString &path);
+    static bool hasMarker(const QString &path);
+
+    std::unique_ptr<QTemporaryDir> m_directory;
+    QString m_path;
+};
+
+QImage tst_QNotificationIconCache::image(QRgb color)
+{
+    QImage image(8, 8, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+// A file that still ends with the marker was not written again
+bool tst_QNotificationIconCache::appendMarker(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::Append) && file.write("marker") == 6;
+}
+
+bool tst_QNotificationIconCache::hasMarker(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) && file.readAll().endsWith("marker");
+}
+
+void tst_QNotificationIconCache::init()
+{
+    m_directory = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_directory->isValid());
+    m_path = m_directory->filePath(u"icons"_s);
+}
+
+void tst_QNotificationIconCache::hit()
+{
+    QNotificationIconCache cache(m_path);
+    const QImage red = image(qRgb(255, 0, 0));
+    const QString path = cache.pathForImage(red);
+    QVERIFY(!path.isEmpty());
+    QVERIFY(path.startsWith(m_path));
+    QCOMPARE(QImage(path).convertToFormat(red.format()), red);
+    QVERIFY(appendMarker(path));
+
+    // The same image, and a copy with the same pixels, use the file written first
+    QCOMPARE(cache.pathForImage(red), path);
+    const QImage copy = image(qRgb(255, 0, 0));
+    QVERIFY(copy.cacheKey() != red.cacheKey());
+    QCOMPARE(cache.pathForImage(copy), path);
+    QVERIFY(hasMarker(path));
+
+    QVERIFY(cache.pathForImage(image(qRgb(0, 255, 0))) != path);
+    QVERIFY(cache.pathForImage(QImage()).isEmpty());
+}
+
+void tst_QNotificationIconCache::rewriteRemoved()
+{
+    QNotificationIconCache cache(m_path);
+    const QImage red = image(qRgb(255, 0, 0));
+    const QString path = cache.pathForImage(red);
+    QVERIFY(!path.isEmpty());
+
+    // A file removed behind the cache's back is written again
+    QVERIFY(QFile::remove(path));
+    QCOMPARE(cache.pathForImage(red), path);
+    QVERIFY(QFileInfo::exists(path));
+}
+
+void tst_QNotificationIconCache::eviction()
+{
+    QNotificationIconCache cache(m_path);
+    cache.setMaximumEntries(2);
+    const QString red = cache.pathForImage(image(qRgb(255, 0, 0)));
+    const QString green = cache.pathForImage(image(qRgb(0, 255, 0)));
+    QVERIFY(!red.isEmpty() && !green.isEmpty());
+
+    // Using red again makes green the least recently used entry
+    QCOMPARE(cache.pathForImage(image(qRgb(255, 0, 0))), red);
+    const QString blue = cache.pathForImage(image(qRgb(0, 0, 255)));
+    QVERIFY(!blue.isEmpty());
+    QVERIFY(QFileInfo::exists(red));
+    QVERIFY(!QFileInfo::exists(green));
+    QVERIFY(QFileInfo::exists(blue));
+
+    // Lowering the limit evicts right away
+    cache.setMaximumEntries(1);
+    QVERIFY(!QFileInfo::exists(red));
+    QVERIFY(QFileInfo::exists(blue));
+}
+
+void tst_QNotificationIconCache::restart()
+{
+    QString red;
+    QString green;
+    {
+        QNotificationIconCache cache(m_path);
+        red = cache.pathForImage(image(qRgb(255, 0, 0)));
+        green = cache.pathForImage(image(qRgb(0, 255, 0)));
+        QVERIFY(!red.isEmpty() && !green.isEmpty());
+    }
+    QVERIFY(appendMarker(green));
+
+    // The file times order the entries for the next run
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (const auto &[path, time] : { std::pair(red, now.addSecs(-20)), std::pair(green, now.addSecs(-10)) }) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::Append));
+        QVERIFY(file.setFileTime(time, QFileDevice::FileModificationTime));
+    }
+
+    // The next run finds the entries without writing them again, and evicts
+    // the least recently used of them first
+    QNotificationIconCache cache(m_path);
+    cache.setMaximumEntries(2);
+    QCOMPARE(cache.pathForImage(image(qRgb(0, 255, 0))), green);
+    QVERIFY(hasMarker(green));
+    const QString blue = cache.pathForImage(image(qRgb(0, 0, 255)));
+    QVERIFY(!blue.isEmpty());
+    QVERIFY(!QFileInfo::exists(red));
+    QVERIFY(QFileInfo::exists(green));
+    QVERIFY(QFileInfo::exists(blue));
+}
+
+void tst_QNotificationIconCache::untrustedDirectory()
+{
+#if defined(Q_OS_UNIX)
+    // Images in a directory that others can write to are not used
+    QVERIFY(QDir().mkdir(m_path));
+    QVERIFY(QFile::setPermissions(m_path, QFileDevice::ReadOwner | QFileDevice::WriteOwner
+                                          | QFileDevice::ExeOwner | QFileDevice::WriteOther
+                                          | QFileDevice::ExeOther));
+    QNotificationIconCache cache(m_path);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"not private to the user"_s));
+    QVERIFY(cache.pathForImage(image(qRgb(255, 0, 0))).isEmpty());
+#else
+    QSKIP("The ownership of directories is only checked on Unix");
+#endif
+}
+
+QTEST_GUILESS_MAIN(tst_QNotificationIconCache)
+
+#include "tst_qnotificationiconcache.moc"
@@ -0,0 +1,168 @@
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include <QtNotifications/private/qnotificationjournal_p.h>
+
+#include <cstring>
+#include <memory>
+
+using namespace Qt::StringLiterals;
+
+class tst_QNotificationJournal : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+
+    void replay();
+    void compaction();
+    void serverIdentity();
+    void reset();
+    void lock();
+
+private:
+    static QList<uint> outstandingIds(const QNotificationJournal &journal);
+    // Number of records in the journal file, as written in its header
+    quint64 recordCount() const;
+
+    QTemporaryDir m_directory;
+    QString m_path;
+};
+
+QList<uint> tst_QNotificationJournal::outstandingIds(const QNotificationJournal &journal)
+{
+    QList<uint> notificationIds;
+    for (const QNotificationJournal::Entry &entry : journal.outstandingEntries())
+        notificationIds.append(entry.notificationId);
+    return notificationIds;
+}
+
+quint64 tst_QNotificationJournal::recordCount() const
+{
+    // The header starts with an 8 byte magic and two 32-bit fields
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    const QByteArray header = file.read(24);
+    if (header.size() < 24)
+        return 0;
+    quint64 count = 0;
+    std::memcpy(&count, header.constData() + 16, sizeof(count));
+    return count;
+}
+
+void tst_QNotificationJournal::init()
+{
+    QVERIFY(m_directory.isValid());
+    m_path = m_directory.filePath(QString::fromLatin1(QTest::currentTestFunction()) + u".journal"_s);
+}
+
+void tst_QNotificationJournal::replay()
+{
+    {
+        QNotificationJournal journal(m_path);
+        QVERIFY(journal.open(u"server"_s));
+        QVERIFY(journal.outstandingEntries().isEmpty());
+        journal.append(1, QNotificationJournal::Sent, u"chat"_s);
+        journal.append(2, QNotificationJournal::Sent);
+        journal.append(0, QNotificationJournal::Failed, u"chat"_s);
+        journal.append(3, QNotificationJournal::Sent);
+        journal.append(2, QNotificationJournal::Closed);
+    }
+
+    // Only notifications that were sent and not closed are outstanding
+    QNotificationJournal journal(m_path);
+    QVERIFY(journal.open(u"server"_s));
+    QCOMPARE(outstandingIds(journal), QList<uint>({ 1, 3 }));
+    QCOMPARE(journal.outstandingEntries().first().category, u"chat"_s);
+}
+
+void tst_QNotificationJournal::compaction()
+{
+    {
+        QNotificationJournal journal(m_path);
+        QVERIFY(journal.open(u"server"_s));
+        for (uint notificationId = 1; notificationId <= 100; ++notificationId)
+            journal.append(notificationId, QNotificationJournal::Sent);
+        for (uint notificationId = 1; notificationId <= 100; ++notificationId) {
+            if (notificationId != 42)
+                journal.append(notificationId, QNotificationJournal::Closed);
+        }
+    }
+    QCOMPARE(recordCount(), quint64(199));
+
+    // Opening the journal rewrites it with the outstanding notifications only
+    {
+        QNotificationJournal journal(m_path);
+        QVERIFY(journal.open(u"server"_s));
+        QCOMPARE(outstandingIds(journal), QList<uint>({ 42 }));
+        QCOMPARE(recordCount(), quint64(1));
+        journal.append(101, QNotificationJournal::Sent);
+    }
+
+    // Records appended after compaction follow the compacted ones
+    QNotificationJournal journal(m_path);
+    QVERIFY(journal.open(u"server"_s));
+    QCOMPARE(outstandingIds(journal), QList<uint>({ 42, 101 }));
+}
+
+void tst_QNotificationJournal::serverIdentity()
+{
+    {
+        QNotificationJournal journal(m_path);
+        QVERIFY(journal.open(u"boot/:1.42"_s));
+        journal.append(1, QNotificationJournal::Sent);
+    }
+
+    // IDs of another server may belong to other applications by now
+    {
+        QNotificationJournal journal(m_path);
+        QVERIFY(journal.open(u"boot/:1.99"_s));
+        QVERIFY(journal.outstandingEntries().isEmpty());
+        journal.append(7, QNotificationJournal::Sent);
+    }
+
+    // The journal now belongs to the new server
+    QNotificationJournal journal(m_path);
+    QVERIFY(journal.open(u"boot/:1.99"_s));
+    QCOMPARE(outstandingIds(journal), QList<uint>({ 7 }));
+}
+
+void tst_QNotificationJournal::reset()
+{
+    {
+        QNotificationJournal journal(m_path);
+        QVERIFY(journal.open(u"first"_s));
+        journal.append(1, QNotificationJournal::Sent);
+        // The server was replaced while the journal was open
+        journal.reset(u"second"_s);
+        QVERIFY(journal.outstandingEntries().isEmpty());
+        journal.append(2, QNotificationJournal::Sent);
+    }
+
+    QNotificationJournal journal(m_path);
+    QVERIFY(journal.open(u"second"_s));
+    QCOMPARE(outstandingIds(journal), QList<uint>({ 2 }));
+}
+
+void tst_QNotificationJournal::lock()
+{
+    auto journal = std::make_unique<QNotificationJournal>(m_path);
+    QVERIFY(journal->open(u"server"_s));
+    journal->append(1, QNotificationJournal::Sent);
+
+    // A second writer would overwrite the records of the first
+    QNotificationJournal other(m_path);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"already open"_s));
+    QVERIFY(!other.open(u"server"_s));
+    QVERIFY(other.outstandingEntries().isEmpty());
+
+    // Once the journal is closed, it can be opened again
+    journal.reset();
+    QVERIFY(other.open(u"server"_s));
+    QCOMPARE(outstandingIds(other), QList<uint>({ 1 }));
+}
+
+QTEST_GUILESS_MAIN(tst_QNotificationJournal)
+
+#include "tst_qnotificationjournal.moc"
@@ -0,0 +1,613 @@
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include <QtNotifications/qnotifications.h>
+#include <QtNotifications/qnotificationsstatistics.h>
+#include <QtNotifications/qplatformnotificationengine.h>
+#include <QtNotifications/private/qplatformnotificationengine_loopback_p.h>
+
+#include <array>
+#include <memory>
+#include <numeric>
+
+using namespace Qt::StringLiterals;
+
+// Drives QNotifications through the loopback engine, which answers every send
+// in-process, so that the behavior of QNotifications itself is tested without
+// a notification server.
+class tst_QNotifications : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void defaultEngine();
+    void closeUnknownIds();
+    void updateUnderNewId();
+    void eventsDeliveredToOwner();
+    void ownerOfRenumberedUpdate();
+    void ownersBounded();
+    void rateLimit();
+    void rateLimitSummaryAfterServerRestart();
+    void priorityQueue();
+    void deduplication();
+    void deduplicationOfFailedSends();
+    void postWhileFailing();
+    void replaceDuplicates();
+    void deduplicationAfterServerRestart();
+    void groupCollapse();
+    void groupSummaryUnderNewId();
+    void groupAfterServerRestart();
+    void journal();
+    void statistics();
+
+private:
+    static QPlatformNotificationEngineLoopback *loopback();
+    static QStringList postedTitles(const QList<QList<QVariant>> &posted);
+    static uint postedId(const QList<QList<QVariant>> &posted, const QString &title);
+};
+
+QPlatformNotificationEngineLoopback *tst_QNotifications::loopback()
+{
+    return QPlatformNotificationEngineLoopback::instance();
+}
+
+QStringList tst_QNotifications::postedTitles(const QList<QList<QVariant>> &posted)
+{
+    QStringList titles;
+    for (const QList<QVariant> &arguments : posted)
+        titles.append(arguments.at(1).value<QNotificationRequest>().title());
+    return titles;
+}
+
+uint tst_QNotifications::postedId(const QList<QList<QVariant>> &posted, const QString &title)
+{
+    for (const QList<QVariant> &arguments : posted) {
+        if (arguments.at(1).value<QNotificationRequest>().title() == title)
+            return arguments.at(0).toUInt();
+    }
+    return 0;
+}
+
+void tst_QNotifications::initTestCase()
+{
+    QVERIFY(QNotifications::availableEngines().contains(u"loopback"_s));
+}
+
+void tst_QNotifications::cleanup()
+{
+    loopback()->setFailing(false);
+    loopback()->setRenumberingUpdates(false);
+    loopback()->setRepliesHeld(false);
+    loopback()->releaseReplies();
+}
+
+void tst_QNotifications::defaultEngine()
+{
+    // The loopback engine shows nothing, so it is never picked unless named
+    if (qEnvironmentVariableIsSet("QT_NOTIFICATIONS_ENGINE"))
+        QSKIP("The default engine is overridden by QT_NOTIFICATIONS_ENGINE");
+    QVERIFY(qt_default_notification_engine() != u"loopback"_s);
+
+    QNotifications named(u"loopback"_s);
+    QVERIFY(named.isSupported());
+    QCOMPARE(named.engineName(), u"loopback"_s);
+}
+
+void tst_QNotifications::closeUnknownIds()
+{
+    QNotifications notifications(u"loopback"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+
+    const uint notificationId = notifications.sendNotification(u"Title"_s, u"Message"_s);
+    QVERIFY(notificationId != 0);
+
+    // As with a server, only notifications that are still shown can be closed
+    notifications.closeNotification(0);
+    notifications.closeNotification(notificationId + 1000);
+    notifications.closeNotification(notificationId);
+    notifications.closeNotification(notificationId);
+    QTRY_COMPARE(closed.size(), 1);
+    QCOMPARE(closed.at(0).at(0).toUInt(), notificationId);
+    QCoreApplication::processEvents();
+    QCOMPARE(closed.size(), 1);
+}
+
+void tst_QNotifications::updateUnderNewId()
+{
+    QNotifications notifications(u"loopback"_s);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    const uint notificationId = notifications.sendNotification(QNotificationRequest(u"Download"_s, u"10%"_s));
+    QVERIFY(notificationId != 0);
+    QCOMPARE(posted.size(), 1);
+    QCOMPARE(posted.at(0).at(2).toUInt(), 0u);
+
+    QFuture<uint> updated = notifications.updateNotification(notificationId,
+                                                             QNotificationRequest(u"Download"_s, u"20%"_s));
+    QTRY_COMPARE(posted.size(), 2);
+    QCOMPARE(updated.result(), notificationId);
+    QCOMPARE(posted.at(1).at(0).toUInt(), notificationId);
+    QCOMPARE(posted.at(1).at(2).toUInt(), notificationId);
+
+    // The update is shown as a new notification, which replaces the old one
+    loopback()->setRenumberingUpdates(true);
+    updated = notifications.updateNotification(notificationId, QNotificationRequest(u"Download"_s, u"30%"_s));
+    QTRY_COMPARE(posted.size(), 3);
+    QVERIFY(updated.result() != notificationId);
+    QCOMPARE(posted.at(2).at(0).toUInt(), updated.result());
+    QCOMPARE(posted.at(2).at(2).toUInt(), notificationId);
+}
+
+void tst_QNotifications::eventsDeliveredToOwner()
+{
+    constexpr int InstanceCount = 3;
+    std::array<std::unique_ptr<QNotifications>, InstanceCount> instances;
+    std::array<std::unique_ptr<QSignalSpy>, InstanceCount> clicked;
+    std::array<std::unique_ptr<QSignalSpy>, InstanceCount> closed;
+    std::array<uint, InstanceCount> notificationIds;
+    for (int i = 0; i < InstanceCount; ++i) {
+        instances[i] = std::make_unique<QNotifications>(u"loopback"_s);
+        clicked[i] = std::make_unique<QSignalSpy>(instances[i].get(), &QNotifications::notificationClicked);
+        closed[i] = std::make_unique<QSignalSpy>(instances[i].get(), &QNotifications::notificationClosed);
+        notificationIds[i] = instances[i]->sendNotification(u"Title"_s, QString::number(i));
+        QVERIFY(notificationIds[i] != 0);
+        QCOMPARE(loopback()->notificationsOwnedBy(instances[i].get()), QList<uint>{ notificationIds[i] });
+    }
+
+    // A click also closes the notification
+    for (uint notificationId : notificationIds)
+        loopback()->simulateClick(notificationId);
+    QCoreApplication::processEvents();
+
+    for (int i = 0; i < InstanceCount; ++i) {
+        QCOMPARE(clicked[i]->size(), 1);
+        QCOMPARE(clicked[i]->at(0).at(0).toUInt(), notificationIds[i]);
+        QCOMPARE(closed[i]->size(), 1);
+        QCOMPARE(closed[i]->at(0).at(0).toUInt(), notificationIds[i]);
+        QVERIFY(loopback()->notificationsOwnedBy(instances[i].get()).isEmpty());
+    }
+}
+
+void tst_QNotifications::ownerOfRenumberedUpdate()
+{
+    QNotifications notifications(u"loopback"_s);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    const uint notificationId = notifications.sendNotification(u"Download"_s, u"10%"_s);
+    QVERIFY(notificationId != 0);
+
+    // The replaced notification is gone, so its ID is no longer ours
+    loopback()->setRenumberingUpdates(true);
+    QFuture<uint> updated = notifications.updateNotification(notificationId,
+                                                             QNotificationRequest(u"Download"_s, u"20%"_s));
+    QTRY_COMPARE(posted.size(), 2);
+    QCOMPARE(loopback()->notificationsOwnedBy(&notifications), QList<uint>{ updated.result() });
+}
+
+void tst_QNotifications::ownersBounded()
+{
+    QNotifications notifications(u"loopback"_s);
+    QNotifications other(u"loopback"_s);
+
+    // An engine that never reports closes must not record owners forever
+    constexpr uint FirstId = 1000000;
+    constexpr uint Count = 10000;
+    for (uint notificationId = FirstId; notificationId < FirstId + Count; ++notificationId)
+        loopback()->setNotificationOwner(notificationId, notificationId % 2 ? &notifications : &other);
+
+    const QList<uint> owned = loopback()->notificationsOwnedBy(&notifications);
+    QVERIFY(owned.size() + loopback()->notificationsOwnedBy(&other).size() <= 4096);
+    // The newest entries are kept
+    QVERIFY(owned.contains(FirstId + Count - 1));
+    QVERIFY(!owned.contains(FirstId + 1));
+}
+
+void tst_QNotifications::rateLimit()
+{
+    QNotifications notifications(u"loopback"_s);
+    // Practically no refill, so that only the burst gets through
+    notifications.setRateLimit(u"chat"_s, 0.001, 2);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    QNotificationRequest request(u"Message"_s, u"Hello"_s);
+    request.setCategory(u"chat"_s);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    for (int i = 0; i < 3; ++i)
+        QCOMPARE(notifications.sendNotification(request), 0u);
+    QCOMPARE(notifications.suppressedNotificationCount(), quint64(3));
+
+    // Other categories are not limited
+    QNotificationRequest other(u"Mail"_s, u"Hello"_s);
+    other.setCategory(u"mail"_s);
+    for (int i = 0; i < 5; ++i)
+        QVERIFY(notifications.sendNotification(other) != 0);
+
+    // The suppressed notifications are reported by a single summary
+    QTRY_COMPARE(notifications.summarizedNotificationCount(), quint64(3));
+    QTRY_VERIFY(postedTitles(posted).contains(u"3 more event(s)"_s));
+
+    // Later suppressed notifications update the summary shown
+    const uint summaryId = postedId(posted, u"3 more event(s)"_s);
+    QVERIFY(summaryId != 0);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).contains(u"4 more event(s)"_s));
+    QCOMPARE(postedId(posted, u"4 more event(s)"_s), summaryId);
+}
+
+void tst_QNotifications::rateLimitSummaryAfterServerRestart()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setRateLimit(u"chat"_s, 0.001, 1);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    QNotificationRequest request(u"Message"_s, u"Hello"_s);
+    request.setCategory(u"chat"_s);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).contains(u"2 more event(s)"_s));
+    const uint summaryId = postedId(posted, u"2 more event(s)"_s);
+    QVERIFY(summaryId != 0);
+
+    // The summary went with the server, so the next one is sent anew rather
+    // than as an update of an ID that the new server may have given to another
+    // notification, and it counts only what it reports itself
+    loopback()->simulateServerRestart();
+    QCoreApplication::processEvents();
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).contains(u"1 more event(s)"_s));
+    const QList<QVariant> &summary = posted.constLast();
+    QCOMPARE(summary.at(1).value<QNotificationRequest>().title(), u"1 more event(s)"_s);
+    QVERIFY(summary.at(0).toUInt() != summaryId);
+    QCOMPARE(summary.at(2).toUInt(), 0u);
+}
+
+void tst_QNotifications::priorityQueue()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setMaximumInFlight(1);
+    notifications.setBackpressureThreshold(2);
+    QSignalSpy backpressure(&notifications, &QNotifications::backpressure);
+    loopback()->setRepliesHeld(true);
+
+    QNotificationRequest low(u"Low"_s, QString());
+    low.setUrgency(QNotificationRequest::Low);
+    QNotificationRequest normal(u"Normal"_s, QString());
+    normal.setUrgency(QNotificationRequest::Normal);
+    QNotificationRequest critical(u"Critical"_s, QString());
+    critical.setUrgency(QNotificationRequest::Critical);
+
+    // The first send takes the only slot, the others wait for it
+    QFuture<uint> lowFuture = notifications.sendNotificationAsync(low);
+    QFuture<uint> normalFuture = notifications.sendNotificationAsync(normal);
+    QFuture<uint> criticalFuture = notifications.sendNotificationAsync(critical);
+    QCOMPARE(notifications.queueDepth(), 2);
+    QCOMPARE(backpressure.size(), 1);
+    QCOMPARE(backpressure.at(0).at(0).toBool(), true);
+
+    // The most urgent waiting notification is sent next
+    loopback()->releaseReplies();
+    QTRY_VERIFY(lowFuture.isFinished());
+    QTRY_COMPARE(notifications.queueDepth(), 1);
+    QCOMPARE(backpressure.size(), 2);
+    QCOMPARE(backpressure.at(1).at(0).toBool(), false);
+    loopback()->releaseReplies();
+    QTRY_VERIFY(criticalFuture.isFinished());
+    QTRY_COMPARE(notifications.queueDepth(), 0);
+    loopback()->releaseReplies();
+    QTRY_VERIFY(normalFuture.isFinished());
+
+    // The loopback engine numbers notifications in the order they are sent
+    QVERIFY(lowFuture.result() != 0);
+    QVERIFY(lowFuture.result() < criticalFuture.result());
+    QVERIFY(criticalFuture.result() < normalFuture.result());
+}
+
+void tst_QNotifications::deduplication()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setDeduplication(QNotifications::SuppressDuplicates, 60000);
+
+    const QNotificationRequest request(u"Backup failed"_s, u"Disk full"_s);
+    const uint notificationId = notifications.sendNotification(request);
+    QVERIFY(notificationId != 0);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QCOMPARE(notifications.duplicateNotificationCount(), quint64(1));
+
+    // Only the same title, message and category make a duplicate
+    QVERIFY(notifications.sendNotification(u"Backup failed"_s, u"No network"_s) != 0);
+    QNotificationRequest otherCategory = request;
+    otherCategory.setCategory(u"backup"_s);
+    QVERIFY(notifications.sendNotification(otherCategory) != 0);
+
+    // A closed notification is forgotten, so it can be shown again
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+    loopback()->simulateClose(notificationId);
+    QTRY_COMPARE(closed.size(), 1);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QCOMPARE(notifications.duplicateNotificationCount(), quint64(1));
+}
+
+void tst_QNotifications::deduplicationOfFailedSends()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setDeduplication(QNotifications::SuppressDuplicates, 60000);
+
+    // A notification that failed to send does not make its repeats duplicates
+    const QNotificationRequest request(u"Backup failed"_s, u"Disk full"_s);
+    loopback()->setFailing(true);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    loopback()->setFailing(false);
+    QVERIFY(notifications.sendNotification(request) != 0);
+
+    const QNotificationRequest asyncRequest(u"Sync failed"_s, u"Disk full"_s);
+    loopback()->setFailing(true);
+    QFuture<uint> failed = notifications.sendNotificationAsync(asyncRequest);
+    QTRY_VERIFY(failed.isFinished());
+    QCOMPARE(failed.result(), 0u);
+    loopback()->setFailing(false);
+    QCoreApplication::processEvents();
+    QFuture<uint> sent = notifications.sendNotificationAsync(asyncRequest);
+    QTRY_VERIFY(sent.isFinished());
+    QVERIFY(sent.result() != 0);
+
+    // Neither does one held back by a rate limit
+    notifications.setRateLimit(u"limited"_s, 0.001, 1);
+    QNotificationRequest first(u"Limited"_s, u"First"_s);
+    first.setCategory(u"limited"_s);
+    QNotificationRequest second(u"Limited"_s, u"Second"_s);
+    second.setCategory(u"limited"_s);
+    QVERIFY(notifications.sendNotification(first) != 0);
+    QCOMPARE(notifications.sendNotification(second), 0u);
+    notifications.clearRateLimit(u"limited"_s);
+    QVERIFY(notifications.sendNotification(second) != 0);
+
+    QCOMPARE(notifications.duplicateNotificationCount(), quint64(0));
+}
+
+void tst_QNotifications::postWhileFailing()
+{
+    QNotifications notifications(u"loopback"_s);
+    const quint64 sentBefore = notifications.statistics().sentCount();
+
+    // A notification that the engine did not hand on is not counted as sent
+    loopback()->setFailing(true);
+    notifications.postNotification(u"Title"_s, u"Message"_s);
+    QCOMPARE(notifications.statistics().sentCount(), sentBefore);
+
+    loopback()->setFailing(false);
+    notifications.postNotification(u"Title"_s, u"Message"_s);
+    QCOMPARE(notifications.statistics().sentCount(), sentBefore + 1);
+}
+
+void tst_QNotifications::replaceDuplicates()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setDeduplication(QNotifications::ReplaceDuplicates, 60000);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    const QNotificationRequest request(u"Backup failed"_s, u"Disk full"_s);
+    const uint notificationId = notifications.sendNotification(request);
+    QVERIFY(notificationId != 0);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+
+    // The notification shown counts its repeats instead
+    QTRY_VERIFY(postedTitles(posted).contains(u"Backup failed (3)"_s));
+    QCOMPARE(postedId(posted, u"Backup failed (3)"_s), notificationId);
+}
+
+void tst_QNotifications::deduplicationAfterServerRestart()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setDeduplication(QNotifications::ReplaceDuplicates, 60000);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    const QNotificationRequest request(u"Backup failed"_s, u"Disk full"_s);
+    const uint notificationId = notifications.sendNotification(request);
+    QVERIFY(notificationId != 0);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QCOMPARE(notifications.duplicateNotificationCount(), quint64(1));
+
+    // The notification went with the server, so it is shown again rather than
+    // bumped under an ID that the new server may have given to another one
+    loopback()->simulateServerRestart();
+    QCoreApplication::processEvents();
+    const qsizetype postedBefore = posted.size();
+    const uint shownAgain = notifications.sendNotification(request);
+    QVERIFY(shownAgain != 0);
+    QVERIFY(shownAgain != notificationId);
+    QCOMPARE(notifications.duplicateNotificationCount(), quint64(1));
+
+    // Its repeats are counted by the new notification
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).mid(postedBefore).contains(u"Backup failed (2)"_s));
+    QCOMPARE(postedId(posted.mid(postedBefore), u"Backup failed (2)"_s), shownAgain);
+}
+
+void tst_QNotifications::groupCollapse()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setGroupThreshold(2);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+
+    QNotificationRequest request(u"Mail"_s, u"New message"_s);
+    request.setGroup(u"inbox"_s);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QCOMPARE(closed.size(), 0);
+
+    // One more than the threshold replaces the group with a summary
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QTRY_COMPARE(closed.size(), 3);
+    QTRY_VERIFY(postedTitles(posted).contains(u"3 new notification(s) from inbox"_s));
+    const uint summaryId = postedId(posted, u"3 new notification(s) from inbox"_s);
+    QVERIFY(summaryId != 0);
+
+    // While collapsed, notifications of the group only update the summary
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).contains(u"4 new notification(s) from inbox"_s));
+    QCOMPARE(postedId(posted, u"4 new notification(s) from inbox"_s), summaryId);
+
+    // Other groups are not affected
+    QNotificationRequest other = request;
+    other.setGroup(u"spam"_s);
+    QVERIFY(notifications.sendNotification(other) != 0);
+
+    // Once the summary is closed, the group is shown one by one again
+    loopback()->simulateClose(summaryId);
+    QTRY_COMPARE(closed.size(), 4);
+    QVERIFY(notifications.sendNotification(request) != 0);
+}
+
+void tst_QNotifications::groupSummaryUnderNewId()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setGroupThreshold(1);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+
+    QNotificationRequest request(u"Mail"_s, u"New message"_s);
+    request.setGroup(u"inbox"_s);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QTRY_VERIFY(postedTitles(posted).contains(u"2 new notification(s) from inbox"_s));
+    const uint summaryId = postedId(posted, u"2 new notification(s) from inbox"_s);
+
+    // The update of the summary is shown under a new ID, which later updates use
+    loopback()->setRenumberingUpdates(true);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).contains(u"3 new notification(s) from inbox"_s));
+    const uint renumberedId = postedId(posted, u"3 new notification(s) from inbox"_s);
+    QVERIFY(renumberedId != summaryId);
+
+    loopback()->setRenumberingUpdates(false);
+    QCOMPARE(notifications.sendNotification(request), 0u);
+    QTRY_VERIFY(postedTitles(posted).contains(u"4 new notification(s) from inbox"_s));
+    QCOMPARE(postedId(posted, u"4 new notification(s) from inbox"_s), renumberedId);
+    QCOMPARE(posted.last().at(2).toUInt(), renumberedId);
+
+    // Closing the summary under its new ID expands the group again
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+    loopback()->simulateClose(renumberedId);
+    QTRY_COMPARE(closed.size(), 1);
+    QVERIFY(notifications.sendNotification(request) != 0);
+}
+
+void tst_QNotifications::groupAfterServerRestart()
+{
+    QNotifications notifications(u"loopback"_s);
+    notifications.setGroupThreshold(1);
+    QSignalSpy posted(&notifications, &QNotifications::notificationPosted);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+
+    QNotificationRequest request(u"Mail"_s, u"New message"_s);
+    request.setGroup(u"inbox"_s);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    QTRY_VERIFY(postedTitles(posted).contains(u"2 new notification(s) from inbox"_s));
+
+    // The summary went with the server, so the group starts over: the next
+    // notification is shown by itself, and the one after it collapses the
+    // group into a new summary
+    loopback()->simulateServerRestart();
+    QCoreApplication::processEvents();
+    const qsizetype postedBefore = posted.size();
+    const qsizetype closedBefore = closed.size();
+    const uint first = notifications.sendNotification(request);
+    QVERIFY(first != 0);
+    QVERIFY(notifications.sendNotification(request) != 0);
+    const QList<QList<QVariant>> postedAfter = posted.mid(postedBefore);
+    const qsizetype summary = postedTitles(postedAfter).indexOf(u"2 new notification(s) from inbox"_s);
+    QVERIFY(summary >= 0);
+    QCOMPARE(postedAfter.at(summary).at(2).toUInt(), 0u);
+    QTRY_COMPARE(closed.size(), closedBefore + 2);
+    QCOMPARE(closed.at(closedBefore).at(0).toUInt(), first);
+}
+
+void tst_QNotifications::journal()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = directory.filePath(u"notifications.journal"_s);
+
+    QList<uint> shown;
+    {
+        QNotifications notifications(u"loopback"_s);
+        QVERIFY(notifications.openJournal(path));
+        QCOMPARE(notifications.journalPath(), path);
+        QVERIFY(notifications.outstandingNotifications().isEmpty());
+
+        // Only one object may record in a journal
+        QNotifications other(u"loopback"_s);
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"already open"_s));
+        QVERIFY(!other.openJournal(path));
+
+        QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+        for (int i = 0; i < 3; ++i)
+            shown.append(notifications.sendNotification(u"Journal"_s, QString::number(i)));
+        QVERIFY(!shown.contains(0u));
+        loopback()->simulateClose(shown.takeAt(1));
+        QTRY_COMPARE(closed.size(), 1);
+    }
+
+    // The next run finds the notifications that were still shown
+    QNotifications notifications(u"loopback"_s);
+    QVERIFY(notifications.openJournal(path));
+    QCOMPARE(notifications.outstandingNotifications(), shown);
+    notifications.adoptOutstandingNotifications();
+    QVERIFY(notifications.outstandingNotifications().isEmpty());
+
+    // Adopted notifications deliver their events to the new object
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+    loopback()->simulateClose(shown.first());
+    QTRY_COMPARE(closed.size(), 1);
+    QCOMPARE(closed.at(0).at(0).toUInt(), shown.first());
+}
+
+static quint64 latencySum(const QNotificationsStatistics &statistics)
+{
+    const QList<quint64> histogram = statistics.latencyHistogram();
+    return std::accumulate(histogram.cbegin(), histogram.cend(), quint64(0));
+}
+
+void tst_QNotifications::statistics()
+{
+    QNotifications notifications(u"loopback"_s);
+    const QNotificationsStatistics before = notifications.statistics();
+    QCOMPARE(before.engineName(), u"loopback"_s);
+    QCOMPARE(before.latencyHistogram().size(), QNotificationsStatistics::latencyBucketBounds().size() + 1);
+
+    // A send is in flight until its reply arrives, then counted with its latency
+    loopback()->setRepliesHeld(true);
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QCOMPARE(notifications.statistics().inFlightCount(), before.inFlightCount() + 1);
+    loopback()->releaseReplies();
+    QTRY_VERIFY(future.isFinished());
+    const uint notificationId = future.result();
+    QVERIFY(notificationId != 0);
+    loopback()->setRepliesHeld(false);
+
+    QVERIFY(notifications.updateNotification(notificationId, QNotificationRequest(u"Title"_s, u"Updated"_s)).result() != 0);
+    loopback()->setFailing(true);
+    QCOMPARE(notifications.sendNotification(u"Title"_s, u"Failing"_s), 0u);
+    loopback()->setFailing(false);
+    // Posted notifications have no reply, so they add no latency
+    notifications.postNotification(u"Title"_s, u"Posted"_s);
+    loopback()->simulateClose(notificationId);
+
+    const QNotificationsStatistics after = notifications.statistics();
+    QCOMPARE(after.sentCount(), before.sentCount() + 2);
+    QCOMPARE(after.updatedCount(), before.updatedCount() + 1);
+    QCOMPARE(after.failedCount(), before.failedCount() + 1);
+    QCOMPARE(after.closedCount(), before.closedCount() + 1);
+    QCOMPARE(after.inFlightCount(), before.inFlightCount());
+    QCOMPARE(latencySum(after), latencySum(before) + 3);
+}
+
+QTEST_GUILESS_MAIN(tst_QNotifications)
+
+#include "tst_qnotifications.moc"
@@ -0,0 +1,116 @@
+#include <QtTest/QtTest>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QThread>
+#include <QtNotifications/private/qnotificationsubmissionqueue_p.h>
+
+#include <memory>
+#include <vector>
+
+using namespace Qt::StringLiterals;
+
+// Pushes from many threads while the queue is drained. The ordering and
+// publication of the nodes is only checked thoroughly in a build configured
+// with -sanitize thread, where ThreadSanitizer reports any data race.
+class tst_QNotificationSubmissionQueue : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void concurrentDrain_data();
+    void concurrentDrain();
+    void destroyWithPending();
+
+private:
+    // The producer and the sequence number of a submission are its title and message
+    static QNotificationSubmission submission(int producer, int sequence);
+};
+
+QNotificationSubmission tst_QNotificationSubmissionQueue::submission(int producer, int sequence)
+{
+    QNotificationSubmission submission;
+    submission.request = QNotificationRequest(QString::number(producer), QString::number(sequence));
+    submission.promise = std::make_shared<QPromise<uint>>();
+    return submission;
+}
+
+void tst_QNotificationSubmissionQueue::concurrentDrain_data()
+{
+    QTest::addColumn<int>("producers");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("1 producer") << 1 << 20000;
+    QTest::newRow("4 producers") << 4 << 10000;
+    QTest::newRow("16 producers") << 16 << 2000;
+}
+
+void tst_QNotificationSubmissionQueue::concurrentDrain()
+{
+    QFETCH(int, producers);
+    QFETCH(int, count);
+
+    QNotificationSubmissionQueue queue;
+    QAtomicInteger<bool> go;
+    QAtomicInteger<int> finished;
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int producer = 0; producer < producers; ++producer) {
+        threads.emplace_back(QThread::create([&queue, &go, &finished, producer, count] {
+            // Start together, so that the pushes contend on the head
+            while (!go.loadAcquire())
+                QThread::yieldCurrentThread();
+            for (int sequence = 0; sequence < count; ++sequence)
+                queue.push(submission(producer, sequence));
+            finished.fetchAndAddRelease(1);
+        }));
+        threads.back()->start();
+    }
+    go.storeRelease(true);
+
+    // Drain while the producers push; every producer's submissions arrive in
+    // the order it pushed them, and none is lost
+    std::vector<int> expected(producers, 0);
+    qsizetype popped = 0;
+    bool ordered = true;
+    while (true) {
+        if (std::optional<QNotificationSubmission> next = queue.pop()) {
+            const int producer = next->request.title().toInt();
+            const int sequence = next->request.message().toInt();
+            ordered = ordered && sequence == expected[producer];
+            expected[producer] = sequence + 1;
+            QVERIFY(next->promise);
+            ++popped;
+            continue;
+        }
+        // A push that exchanged the head but has not linked its node yet
+        // leaves the queue non-empty with nothing to pop
+        if (finished.loadAcquire() == producers && queue.isEmpty())
+            break;
+        QThread::yieldCurrentThread();
+    }
+    for (const std::unique_ptr<QThread> &thread : threads)
+        QVERIFY(thread->wait());
+
+    QVERIFY(ordered);
+    QCOMPARE(popped, qsizetype(producers) * count);
+    for (int producer = 0; producer < producers; ++producer)
+        QCOMPARE(expected[producer], count);
+    QVERIFY(!queue.pop());
+}
+
+void tst_QNotificationSubmissionQueue::destroyWithPending()
+{
+    std::weak_ptr<QPromise<uint>> promise;
+    {
+        QNotificationSubmissionQueue queue;
+        QNotificationSubmission first = submission(0, 0);
+        promise = first.promise;
+        queue.push(std::move(first));
+        queue.push(submission(0, 1));
+        QVERIFY(!queue.isEmpty());
+    }
+    // Submissions still queued are released with the queue
+    QVERIFY(promise.expired());
+}
+
+QTEST_GUILESS_MAIN(tst_QNotificationSubmissionQueue)
+
+#include "tst_qnotificationsubmissionqueue.moc"
@@ -0,0 +1,502 @@
+#include <QtTest/QtTest>
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusMessage>
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+#include <QtNotifications/qnotifications.h>
+
+#include "mocknotificationserver.h"
+
+using namespace Qt::StringLiterals;
+
+// Runs the Linux engine against a mock server on a private session bus.
+class tst_QPlatformNotificationEngineLinux : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void sendAndClose();
+    void closeManyAndAll();
+    void sendWithoutWaiting();
+    void pipelinedBatch();
+    void requestArguments();
+    void spoofedSignals();
+    void circuitBreaker();
+    void rejectedSends();
+    void markupStripped();
+    void updatesUnderNewId();
+    void imageData_data();
+    void imageData();
+    void imageInlineOrCached();
+    void closeAfterServerRestart();
+    void availability();
+    void prewarm();
+
+private:
+    QTemporaryDir m_runtimeDir;
+    MockNotificationBus m_bus;
+    MockNotificationServer *m_server = nullptr;
+};
+
+void tst_QPlatformNotificationEngineLinux::initTestCase()
+{
+    const MockNotificationBus::Status status = m_bus.start();
+    if (status == MockNotificationBus::DaemonUnavailable)
+        QSKIP("dbus-daemon is not available");
+    QCOMPARE(status, MockNotificationBus::Started);
+    m_server = m_bus.server();
+    qunsetenv("QT_NOTIFICATIONS_ENGINE");
+    // Keeps the icon cache out of the user's own runtime directory
+    QVERIFY(m_runtimeDir.isValid());
+    qputenv("XDG_RUNTIME_DIR", QFile::encodeName(m_runtimeDir.path()));
+
+    QNotifications notifications(u"linux"_s);
+    QVERIFY(notifications.isSupported());
+}
+
+void tst_QPlatformNotificationEngineLinux::cleanupTestCase()
+{
+    m_bus.stop();
+    m_server = nullptr;
+}
+
+void tst_QPlatformNotificationEngineLinux::cleanup()
+{
+    if (m_server) {
+        m_server->setReplyDelay(0);
+        m_server->setRejecting(false);
+        m_server->setRenumbering(false);
+        m_server->setRepliesHeld(false);
+        m_server->releaseReplies();
+    }
+    // The timeout is a setting of the engine, which all tests share
+    QNotifications(u"linux"_s).setSendTimeout(-1);
+}
+
+void tst_QPlatformNotificationEngineLinux::sendAndClose()
+{
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(future.isFinished());
+    const uint notificationId = future.result();
+    QVERIFY(notificationId != 0);
+
+    notifications.closeNotification(notificationId);
+    QTRY_COMPARE(closed.size(), 1);
+    QCOMPARE(closed.at(0).at(0).toUInt(), notificationId);
+    QCOMPARE(closed.at(0).at(1).value<QNotifications::ClosedReason>(), QNotifications::Closed);
+}
+
+void tst_QPlatformNotificationEngineLinux::closeManyAndAll()
+{
+    QNotifications notifications(u"linux"_s);
+    QNotifications other(u"linux"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+    QSignalSpy otherClosed(&other, &QNotifications::notificationClosed);
+
+    QList<uint> notificationIds;
+    for (int i = 0; i < 3; ++i)
+        notificationIds.append(notifications.sendNotification(u"Title"_s, QString::number(i)));
+    QVERIFY(!notificationIds.contains(0u));
+    const uint otherId = other.sendNotification(u"Title"_s, u"Other"_s);
+    QVERIFY(otherId != 0);
+    const qsizetype closedBefore = m_server->closedIds().size();
+
+    // Each ID becomes one CloseNotification call
+    notifications.closeNotifications(notificationIds.first(2));
+    QTRY_COMPARE(closed.size(), 2);
+    QCOMPARE(m_server->closedIds().mid(closedBefore), notificationIds.first(2));
+
+    // closeAll() closes what this object still shows, and nothing of others
+    notifications.closeAll();
+    QTRY_COMPARE(closed.size(), 3);
+    QCOMPARE(closed.at(2).at(0).toUInt(), notificationIds.at(2));
+    QCOMPARE(m_server->closedIds().mid(closedBefore + 2), QList<uint>{ notificationIds.at(2) });
+    QCOMPARE(otherClosed.size(), 0);
+
+    // Nothing is left to close
+    notifications.closeAll();
+    other.closeAll();
+    QTRY_COMPARE(otherClosed.size(), 1);
+    QCOMPARE(m_server->closedIds().mid(closedBefore + 3), QList<uint>{ otherId });
+    QCOMPARE(closed.size(), 3);
+}
+
+void tst_QPlatformNotificationEngineLinux::sendWithoutWaiting()
+{
+    QNotifications notifications(u"linux"_s);
+
+    // The future is returned before the server has answered
+    m_server->setRepliesHeld(true);
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Async"_s);
+    QTRY_COMPARE(m_server->heldReplyCount(), 1);
+    QCoreApplication::processEvents();
+    QVERIFY(!future.isFinished());
+    m_server->releaseReplies();
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result() != 0);
+
+    // A posted notification asks for no reply at all
+    m_server->setRepliesHeld(true);
+    notifications.postNotification(u"Title"_s, u"Posted"_s);
+    QTRY_COMPARE(m_server->lastBody(), u"Posted"_s);
+    QCOMPARE(m_server->heldReplyCount(), 0);
+}
+
+void tst_QPlatformNotificationEngineLinux::pipelinedBatch()
+{
+    QNotifications notifications(u"linux"_s);
+
+    // Every call of a batch is written before the first reply is read
+    m_server->setRepliesHeld(true);
+    QList<QNotificationRequest> requests;
+    for (int i = 0; i < 5; ++i)
+        requests.append(QNotificationRequest(u"Title"_s, QString::number(i)));
+    QFuture<QList<uint>> batch = notifications.sendNotifications(requests);
+    QTRY_COMPARE(m_server->heldReplyCount(), 5);
+    QVERIFY(!batch.isFinished());
+    m_server->releaseReplies();
+    QTRY_VERIFY(batch.isFinished());
+    const QList<uint> batchIds = batch.result();
+    QCOMPARE(batchIds.size(), 5);
+    for (qsizetype i = 1; i < batchIds.size(); ++i)
+        QVERIFY(batchIds.at(i) > batchIds.at(i - 1));
+    QVERIFY(batchIds.constFirst() != 0);
+
+    // With batching, sends of one event loop iteration go out together
+    notifications.setBatchingEnabled(true);
+    QList<QFuture<uint>> futures;
+    for (int i = 0; i < 3; ++i)
+        futures.append(notifications.sendNotificationAsync(u"Title"_s, QString::number(i)));
+    QCOMPARE(m_server->heldReplyCount(), 0);
+    QTRY_COMPARE(m_server->heldReplyCount(), 3);
+    for (const QFuture<uint> &future : std::as_const(futures))
+        QVERIFY(!future.isFinished());
+    m_server->releaseReplies();
+    for (const QFuture<uint> &future : std::as_const(futures)) {
+        QTRY_VERIFY(future.isFinished());
+        QVERIFY(future.result() != 0);
+    }
+}
+
+void tst_QPlatformNotificationEngineLinux::requestArguments()
+{
+    QNotifications notifications(u"linux"_s);
+
+    QNotificationRequest request(u"Title"_s, u"Message"_s);
+    request.setUrgency(QNotificationRequest::Critical);
+    request.setCategory(u"im.received"_s);
+    request.setIcon(u"dialog-information"_s);
+    request.setExpireTimeout(5000);
+    request.addAction(u"open"_s, u"Open"_s);
+    request.setHint(u"x-test"_s, 7);
+    QVERIFY(notifications.sendNotification(request) != 0);
+
+    const QVariantList arguments = m_server->lastArguments();
+    QCOMPARE(arguments.size(), 8);
+    QCOMPARE(arguments.at(1).toUInt(), 0u);
+    QCOMPARE(arguments.at(2).toString(), u"dialog-information"_s);
+    QCOMPARE(arguments.at(3).toString(), u"Title"_s);
+    QCOMPARE(arguments.at(4).toString(), u"Message"_s);
+    QCOMPARE(arguments.at(5).toStringList(), QStringList({ u"default"_s, QString(), u"open"_s, u"Open"_s }));
+    const QVariantMap hints = arguments.at(6).toMap();
+    QCOMPARE(hints.value(u"urgency"_s).toInt(), 2);
+    QCOMPARE(hints.value(u"category"_s).toString(), u"im.received"_s);
+    QCOMPARE(hints.value(u"x-test"_s).toInt(), 7);
+    QCOMPARE(arguments.at(7).toInt(), 5000);
+
+    // The keys of the parameter map are lifted into the same fields
+    QVERIFY(notifications.sendNotification(u"Title"_s, u"Message"_s,
+                                           { { u"urgency"_s, 2 }, { u"category"_s, u"im.received"_s },
+                                             { u"icon"_s, u"dialog-information"_s },
+                                             { u"expire-timeout"_s, 5000 }, { u"x-test"_s, 7 } },
+                                           { { u"open"_s, u"Open"_s } }) != 0);
+    QCOMPARE(m_server->lastArguments(), arguments);
+}
+
+void tst_QPlatformNotificationEngineLinux::spoofedSignals()
+{
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+    QSignalSpy invoked(&notifications, &QNotifications::actionInvoked);
+
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(future.isFinished());
+    const uint notificationId = future.result();
+    QVERIFY(notificationId != 0);
+
+    // Another peer on the bus claims that the notification was closed
+    QDBusConnection spoofer = QDBusConnection::connectToBus(m_bus.address(), u"spoofer"_s);
+    QVERIFY(spoofer.isConnected());
+    QDBusMessage spoofed = QDBusMessage::createSignal(u"/org/freedesktop/Notifications"_s,
+                                                      u"org.freedesktop.Notifications"_s,
+                                                      u"NotificationClosed"_s);
+    spoofed << notificationId << 2u;
+    QVERIFY(spoofer.send(spoofed));
+
+    // Signals of the server itself still arrive
+    QMetaObject::invokeMethod(m_server, [this, notificationId] {
+        m_server->emitActionInvoked({ notificationId }, u"open"_s);
+    });
+    QTRY_COMPARE(invoked.size(), 1);
+    QCOMPARE(closed.size(), 0);
+
+    QDBusConnection::disconnectFromBus(u"spoofer"_s);
+    notifications.closeNotification(notificationId);
+    QTRY_COMPARE(closed.size(), 1);
+}
+
+void tst_QPlatformNotificationEngineLinux::circuitBreaker()
+{
+    QNotifications notifications(u"linux"_s);
+    QCOMPARE(notifications.circuitState(), QNotifications::CircuitState::Closed);
+    QSignalSpy stateChanged(&notifications, &QNotifications::circuitStateChanged);
+
+    // Sends that time out open the circuit
+    notifications.setSendTimeout(100);
+    m_server->setReplyDelay(500);
+    QList<QFuture<uint>> futures;
+    for (int i = 0; i < 3; ++i)
+        futures.append(notifications.sendNotificationAsync(u"Title"_s, u"Message"_s));
+    for (const QFuture<uint> &future : std::as_const(futures)) {
+        QTRY_VERIFY(future.isFinished());
+        QCOMPARE(future.result(), 0u);
+    }
+    QTRY_COMPARE(notifications.circuitState(), QNotifications::CircuitState::Open);
+
+    // While open, sends fail right away instead of waiting for the timeout
+    QFuture<uint> rejected = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QVERIFY(rejected.isFinished());
+    QCOMPARE(rejected.result(), 0u);
+
+    // Notifications that expect no reply are dropped instead of queuing up
+    const quint64 sentBefore = notifications.statistics().sentCount();
+    notifications.postNotification(u"Title"_s, u"Posted while open"_s);
+    QCOMPARE(notifications.statistics().sentCount(), sentBefore);
+
+    // A probe that gets a reply closes the circuit again
+    m_server->setReplyDelay(0);
+    QTRY_COMPARE_WITH_TIMEOUT(notifications.circuitState(), QNotifications::CircuitState::Closed, 15000);
+    QVERIFY(stateChanged.size() >= 2);
+    // The server answered the probe after every call written before it
+    QVERIFY(m_server->lastBody() != u"Posted while open"_s);
+
+    QFuture<uint> sent = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(sent.isFinished());
+    QVERIFY(sent.result() != 0);
+}
+
+void tst_QPlatformNotificationEngineLinux::rejectedSends()
+{
+    QNotifications notifications(u"linux"_s);
+    QCOMPARE(notifications.circuitState(), QNotifications::CircuitState::Closed);
+
+    // Error replies come from a server that is answering, so they do not open
+    // the circuit however many there are
+    m_server->setRejecting(true);
+    for (int i = 0; i < 5; ++i) {
+        QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+        QTRY_VERIFY(future.isFinished());
+        QCOMPARE(future.result(), 0u);
+    }
+    QCOMPARE(notifications.sendNotification(QNotificationRequest(u"Title"_s, u"Message"_s)), 0u);
+    QCOMPARE(notifications.circuitState(), QNotifications::CircuitState::Closed);
+
+    m_server->setRejecting(false);
+    QVERIFY(notifications.sendNotification(QNotificationRequest(u"Title"_s, u"Message"_s)) != 0);
+}
+
+void tst_QPlatformNotificationEngineLinux::markupStripped()
+{
+    QNotifications notifications(u"linux"_s);
+    // Until the capabilities are known, markup is passed on as it is
+    QTRY_VERIFY(notifications.capabilities().contains(u"body"_s));
+    QVERIFY(!notifications.capabilities().contains(u"body-markup"_s));
+
+    const QString markup = u"<b>Build</b> <a href=\"https://example.com\">42</a> passed: "
+                           u"a < b and c > d, <I>x</I> &lt;y&gt; &amp; <img src=\"ok.png\" alt=\"ok\"/>z"_s;
+    QVERIFY(notifications.sendNotification(QNotificationRequest(u"Title"_s, markup)) != 0);
+    QCOMPARE(m_server->lastBody(), u"Build 42 passed: a < b and c > d, x <y> & z"_s);
+}
+
+void tst_QPlatformNotificationEngineLinux::updatesUnderNewId()
+{
+    QNotifications notifications(u"linux"_s);
+    const uint notificationId = notifications.sendNotification(QNotificationRequest(u"Download"_s, u"0%"_s));
+    QVERIFY(notificationId != 0);
+
+    m_server->setRenumbering(true);
+    m_server->setReplyDelay(300);
+    const qsizetype updatesBefore = m_server->replacedIds().size();
+    QFuture<uint> first = notifications.updateNotification(notificationId, QNotificationRequest(u"Download"_s, u"10%"_s));
+    QFuture<uint> second = notifications.updateNotification(notificationId, QNotificationRequest(u"Download"_s, u"20%"_s));
+    QTRY_VERIFY(first.isFinished());
+    const uint renumberedId = first.result();
+    QVERIFY(renumberedId != 0);
+    QVERIFY(renumberedId != notificationId);
+
+    // The second update is in flight; one made with the new ID waits for it
+    // instead of racing it
+    QFuture<uint> third = notifications.updateNotification(renumberedId, QNotificationRequest(u"Download"_s, u"30%"_s));
+    QTRY_VERIFY_WITH_TIMEOUT(third.isFinished(), 10000);
+    QVERIFY(second.isFinished());
+    QVERIFY(third.result() != 0);
+    QCOMPARE(m_server->replacedIds().mid(updatesBefore),
+             QList<uint>({ notificationId, renumberedId, second.result() }));
+}
+
+void tst_QPlatformNotificationEngineLinux::imageData_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<bool>("hasAlpha");
+
+    // Already in the layout of the specification, so sent as it is
+    QTest::newRow("RGBA8888") << int(QImage::Format_RGBA8888) << true;
+    QTest::newRow("RGB888") << int(QImage::Format_RGB888) << false;
+    // Converted once before sending
+    QTest::newRow("ARGB32") << int(QImage::Format_ARGB32) << true;
+    QTest::newRow("ARGB32_Premultiplied") << int(QImage::Format_ARGB32_Premultiplied) << true;
+    QTest::newRow("RGB32") << int(QImage::Format_RGB32) << false;
+    QTest::newRow("Grayscale8") << int(QImage::Format_Grayscale8) << false;
+}
+
+void tst_QPlatformNotificationEngineLinux::imageData()
+{
+    QFETCH(int, format);
+    QFETCH(bool, hasAlpha);
+
+    // An odd width makes rows of three channels padded
+    QImage image(5, 3, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixelColor(x, y, QColor(40 * x, 80 * y, 200, hasAlpha ? 255 - 50 * x : 255));
+    }
+    image = image.convertToFormat(QImage::Format(format));
+
+    QNotifications notifications(u"linux"_s);
+    QNotificationRequest request(u"Title"_s, u"Image"_s);
+    request.setImage(image);
+    QVERIFY(notifications.sendNotification(request) != 0);
+
+    const MockNotificationServer::ImageData received = m_server->lastImageData();
+    const QImage expected = image.convertToFormat(hasAlpha ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+    QCOMPARE(received.width, expected.width());
+    QCOMPARE(received.height, expected.height());
+    QCOMPARE(received.rowStride, expected.bytesPerLine());
+    QCOMPARE(received.hasAlpha, hasAlpha);
+    QCOMPARE(received.bitsPerSample, 8);
+    QCOMPARE(received.channels, hasAlpha ? 4 : 3);
+    QCOMPARE(received.data.size(), expected.sizeInBytes());
+    const QImage receivedImage(reinterpret_cast<const uchar *>(received.data.constData()), received.width,
+                               received.height, received.rowStride, expected.format());
+    QCOMPARE(receivedImage, expected);
+}
+
+void tst_QPlatformNotificationEngineLinux::imageInlineOrCached()
+{
+    QNotifications notifications(u"linux"_s);
+    QImage image(256, 256, QImage::Format_RGBA8888);
+    image.fill(Qt::red);
+
+    // A request image is sent inline, however large it is
+    QNotificationRequest inlined(u"Title"_s, u"Inline"_s);
+    inlined.setImage(image);
+    QFuture<uint> future = notifications.sendNotificationAsync(inlined);
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result() != 0);
+    QVariantMap hints = m_server->lastHints();
+    QVERIFY(hints.contains(u"image-data"_s));
+    QVERIFY(!hints.contains(u"image-path"_s));
+
+    // An image given as image-path is passed as its file in the icon cache
+    QNotificationRequest cached(u"Title"_s, u"Cached"_s);
+    cached.setHint(u"image-path"_s, QVariant::fromValue(image));
+    future = notifications.sendNotificationAsync(cached);
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result() != 0);
+    hints = m_server->lastHints();
+    QVERIFY(!hints.contains(u"image-data"_s));
+    const QUrl url(hints.value(u"image-path"_s).toString());
+    QVERIFY(url.isLocalFile());
+    QVERIFY(url.toLocalFile().startsWith(m_runtimeDir.path()));
+    QCOMPARE(QImage(url.toLocalFile()).convertToFormat(image.format()), image);
+}
+
+void tst_QPlatformNotificationEngineLinux::closeAfterServerRestart()
+{
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy availabilityChanged(&notifications, &QNotifications::availabilityChanged);
+
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(future.isFinished());
+    const uint notificationId = future.result();
+    QVERIFY(notificationId != 0);
+
+    // The server goes away and another one takes the service
+    QVERIFY(m_bus.restartServer());
+    QTRY_COMPARE(availabilityChanged.size(), 2);
+    QVERIFY(notifications.isAvailable());
+    const qsizetype closedBefore = m_server->closedIds().size();
+
+    // The ID may belong to another application now, so it is not closed
+    notifications.closeNotification(notificationId);
+    notifications.closeAll();
+    notifications.closeNotification(notificationId + 1000);
+
+    // Calls are served in order, so the reply to this send comes after them
+    future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result() != 0);
+    QCOMPARE(m_server->closedIds().size(), closedBefore);
+
+    notifications.closeAll();
+    QTRY_COMPARE(m_server->closedIds().mid(closedBefore), QList<uint>{ future.result() });
+}
+
+void tst_QPlatformNotificationEngineLinux::availability()
+{
+    QNotifications notifications(u"linux"_s);
+    QTRY_VERIFY(notifications.isAvailable());
+    QSignalSpy availabilityChanged(&notifications, &QNotifications::availabilityChanged);
+
+    // Nothing on the private bus can start a server once the mock is gone
+    QMetaObject::invokeMethod(m_server, [this] { m_server->stop(); }, Qt::BlockingQueuedConnection);
+    QTRY_COMPARE(availabilityChanged.size(), 1);
+    QCOMPARE(availabilityChanged.at(0).at(0).toBool(), false);
+    QVERIFY(!notifications.isAvailable());
+
+    bool registered = false;
+    QMetaObject::invokeMethod(m_server, [this, &registered] {
+        registered = m_server->start(m_bus.address());
+    }, Qt::BlockingQueuedConnection);
+    QVERIFY(registered);
+    QTRY_COMPARE(availabilityChanged.size(), 2);
+    QCOMPARE(availabilityChanged.at(1).at(0).toBool(), true);
+    QVERIFY(notifications.isAvailable());
+}
+
+void tst_QPlatformNotificationEngineLinux::prewarm()
+{
+    QNotifications notifications(u"linux"_s);
+    const int before = m_server->serverInformationCount();
+
+    // The server is asked once, without blocking
+    notifications.prewarm();
+    QTRY_COMPARE(m_server->serverInformationCount(), before + 1);
+
+    // Once is enough, for every QNotifications object of the engine
+    QNotifications(u"linux"_s).prewarm();
+    notifications.prewarm();
+    QVERIFY(notifications.sendNotification(u"Title"_s, u"Message"_s) != 0);
+    QCOMPARE(m_server->serverInformationCount(), before + 1);
+}
+
+QTEST_GUILESS_MAIN(tst_QPlatformNotificationEngineLinux)
+
+#include "tst_qplatformnotificationengine_linux.moc"
@@ -0,0 +1,166 @@
+#include <QtTest/QtTest>
+#include <QtNotifications/qnotifications.h>
+
+#include "mocknotificationserver.h"
+
+#include <array>
+#include <memory>
+
+using namespace Qt::StringLiterals;
+
+// Runs the Linux engine on its own thread, as enabled by
+// QNotifications::setEngineThreadEnabled(), against a mock server on a private
+// session bus. The setting is read when the engine is created, so it has a
+// test executable of its own.
+class tst_QPlatformNotificationEngineLinuxThread : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void sendAndClose();
+    void eventsRightAfterReply();
+    void destroyedWhileEventsArrive();
+    void submitFromOtherThreads();
+
+private:
+    MockNotificationBus m_bus;
+    MockNotificationServer *m_server = nullptr;
+};
+
+void tst_QPlatformNotificationEngineLinuxThread::initTestCase()
+{
+    const MockNotificationBus::Status status = m_bus.start();
+    if (status == MockNotificationBus::DaemonUnavailable)
+        QSKIP("dbus-daemon is not available");
+    QCOMPARE(status, MockNotificationBus::Started);
+    m_server = m_bus.server();
+    qunsetenv("QT_NOTIFICATIONS_ENGINE");
+
+    QNotifications::setEngineThreadEnabled(true);
+    QNotifications notifications(u"linux"_s);
+    QVERIFY(notifications.isSupported());
+}
+
+void tst_QPlatformNotificationEngineLinuxThread::cleanupTestCase()
+{
+    m_bus.stop();
+    m_server = nullptr;
+}
+
+void tst_QPlatformNotificationEngineLinuxThread::cleanup()
+{
+    if (m_server)
+        m_server->setExpiringOnNotify(false);
+}
+
+void tst_QPlatformNotificationEngineLinuxThread::sendAndClose()
+{
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+
+    // Blocking sends wait for the engine's thread
+    const uint notificationId = notifications.sendNotification(u"Title"_s, u"Message"_s);
+    QVERIFY(notificationId != 0);
+
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.result() != 0);
+
+    notifications.closeAll();
+    QTRY_COMPARE(closed.size(), 2);
+    QSet<uint> closedIds;
+    for (const QList<QVariant> &arguments : std::as_const(closed))
+        closedIds.insert(arguments.at(0).toUInt());
+    QCOMPARE(closedIds, QSet<uint>({ notificationId, future.result() }));
+}
+
+void tst_QPlatformNotificationEngineLinuxThread::eventsRightAfterReply()
+{
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+
+    // The engine's thread handles the signal right after the reply, possibly
+    // before this thread has seen the ID; the owner is known by then
+    m_server->setExpiringOnNotify(true);
+    constexpr int Count = 50;
+    QList<QFuture<uint>> futures;
+    for (int i = 0; i < Count; ++i)
+        futures.append(notifications.sendNotificationAsync(u"Title"_s, QString::number(i)));
+    futures.append(notifications.sendNotifications({ QNotificationRequest(u"Title"_s, u"A"_s),
+                                                     QNotificationRequest(u"Title"_s, u"B"_s) })
+                           .then([](const QList<uint> &notificationIds) { return notificationIds.value(1); }));
+    QVERIFY(notifications.sendNotification(u"Title"_s, u"Blocking"_s) != 0);
+
+    QTRY_COMPARE(closed.size(), Count + 3);
+    for (const QList<QVariant> &arguments : std::as_const(closed))
+        QCOMPARE(arguments.at(1).value<QNotifications::ClosedReason>(), QNotifications::Expired);
+}
+
+void tst_QPlatformNotificationEngineLinuxThread::destroyedWhileEventsArrive()
+{
+    // Events for an owner that is being destroyed are dropped, not delivered to
+    // a dangling object
+    for (int round = 0; round < 20; ++round) {
+        auto notifications = std::make_unique<QNotifications>(u"linux"_s);
+        QFuture<uint> future = notifications->sendNotificationAsync(u"Title"_s, u"Message"_s);
+        QTRY_VERIFY(future.isFinished());
+        const uint notificationId = future.result();
+        QVERIFY(notificationId != 0);
+
+        QMetaObject::invokeMethod(m_server, [this, notificationId] {
+            m_server->emitActionInvoked(QList<uint>(100, notificationId), u"open"_s);
+        });
+        // Some replies may still be in flight when the owner goes away
+        m_server->setExpiringOnNotify(true);
+        for (int i = 0; i < 10; ++i)
+            notifications->sendNotificationAsync(u"Title"_s, QString::number(i));
+        m_server->setExpiringOnNotify(false);
+        notifications.reset();
+    }
+
+    // The engine still delivers to owners that exist
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy invoked(&notifications, &QNotifications::actionInvoked);
+    QFuture<uint> future = notifications.sendNotificationAsync(u"Title"_s, u"Message"_s);
+    QTRY_VERIFY(future.isFinished());
+    const uint notificationId = future.result();
+    QMetaObject::invokeMethod(m_server, [this, notificationId] {
+        m_server->emitActionInvoked({ notificationId }, u"open"_s);
+    });
+    QTRY_COMPARE(invoked.size(), 1);
+    QCOMPARE(invoked.at(0).at(0).toUInt(), notificationId);
+}
+
+void tst_QPlatformNotificationEngineLinuxThread::submitFromOtherThreads()
+{
+    QNotifications notifications(u"linux"_s);
+    QSignalSpy closed(&notifications, &QNotifications::notificationClosed);
+    m_server->setExpiringOnNotify(true);
+
+    constexpr int ThreadCount = 4;
+    constexpr int PerThread = 25;
+    std::array<std::unique_ptr<QThread>, ThreadCount> threads;
+    for (auto &thread : threads) {
+        thread.reset(QThread::create([&notifications] {
+            for (int i = 0; i < PerThread; ++i)
+                notifications.submitNotification(QNotificationRequest(u"Title"_s, QString::number(i)));
+        }));
+        thread->start();
+    }
+    for (auto &thread : threads)
+        QVERIFY(thread->wait());
+
+    // Every notification expires, and its owner hears of it once
+    QTRY_COMPARE(closed.size(), ThreadCount * PerThread);
+    QSet<uint> closedIds;
+    for (const QList<QVariant> &arguments : std::as_const(closed))
+        closedIds.insert(arguments.at(0).toUInt());
+    QCOMPARE(closedIds.size(), ThreadCount * PerThread);
+}
+
+QTEST_GUILESS_MAIN(tst_QPlatformNotificationEngineLinuxThread)
+#include "tst_qplatformnotificationengine_linux_thread.moc"
@@ -0,0 +1,220 @@
+#include <QtTest/QtTest>
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtNotifications/qnotifications.h>
+
+#include "mocknotificationserver.h"
+
+#include <algorithm>
+
+using namespace Qt::StringLiterals;
+
+class tst_bench_QNotifications : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sendSync();
+    void sendAsync();
+    void sendBatch();
+    void dispatchActionInvoked();
+    void dispatchNotificationClosed();
+
+private:
+    struct Samples
+    {
+        QList<qint64> nanoseconds;
+        qint64 totalNanoseconds = 0;
+    };
+
+    QList<uint> sendAndWait(int count);
+    void record(const QString &name, const Samples &samples);
+    void recordDispatch(const QString &name, int count, qint64 nanoseconds);
+    template <typename Emit, typename Signal>
+    void measureDispatch(const QString &name, Signal signal, Emit emitEvents);
+
+    MockNotificationBus m_bus;
+    MockNotificationServer *m_server = nullptr;
+    QNotifications *m_notifications = nullptr;
+    QJsonObject m_results;
+    int m_iterations = 1000;
+};
+
+void tst_bench_QNotifications::initTestCase()
+{
+    const MockNotificationBus::Status status = m_bus.start();
+    if (status == MockNotificationBus::DaemonUnavailable)
+        QSKIP("dbus-daemon is not available");
+    QCOMPARE(status, MockNotificationBus::Started);
+    m_server = m_bus.server();
+
+    const int iterations = qEnvironmentVariableIntValue("QTNOTIFICATIONS_BENCHMARK_ITERATIONS");
+    if (iterations > 0)
+        m_iterations = iterations;
+
+    m_notifications = new QNotifications(this);
+    QVERIFY(m_notifications->isSupported());
+}
+
+void tst_bench_QNotifications::cleanupTestCase()
+{
+    m_bus.stop();
+    m_server = nullptr;
+
+    QJsonObject report;
+    report[u"qtVersion"_s] = QString::fromLatin1(qVersion());
+    report[u"timestamp"_s] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report[u"iterations"_s] = m_iterations;
+    report[u"results"_s] = m_results;
+
+    QString path = qEnvironmentVariable("QTNOTIFICATIONS_BENCHMARK_JSON");
+    if (path.isEmpty())
+        path = u"tst_bench_qnotifications.json"_s;
+    QFile file(path);
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    file.write(QJsonDocument(report).toJson());
+    qInfo("Benchmark results written to %s", qPrintable(QFileInfo(file).absoluteFilePath()));
+}
+
+void tst_bench_QNotifications::record(const QString &name, const Samples &samples)
+{
+    QList<qint64> sorted = samples.nanoseconds;
+    std::sort(sorted.begin(), sorted.end());
+    const auto percentile = [&sorted](double fraction) {
+        if (sorted.isEmpty())
+            return 0.0;
+        const qsizetype index = qMin(sorted.size() - 1, qsizetype(fraction * sorted.size()));
+        return sorted.at(index) / 1000.0;
+    };
+
+    QJsonObject result;
+    result[u"count"_s] = sorted.size();
+    result[u"sendsPerSecond"_s] = samples.totalNanoseconds > 0
+            ? sorted.size() * 1e9 / samples.totalNanoseconds : 0.0;
+    result[u"p50LatencyUs"_s] = percentile(0.50);
+    result[u"p99LatencyUs"_s] = percentile(0.99);
+    m_results[name] = result;
+
+    QTest::setBenchmarkResult(samples.totalNanoseconds / 1e6, QTest::WalltimeMilliseconds);
+}
+
+void tst_bench_QNotifications::recordDispatch(const QString &name, int count, qint64 nanoseconds)
+{
+    QJsonObject result;
+    result[u"count"_s] = count;
+    result[u"signalsPerSecond"_s] = nanoseconds > 0 ? count * 1e9 / nanoseconds : 0.0;
+    m_results[name] = result;
+
+    QTest::setBenchmarkResult(nanoseconds / 1e6, QTest::WalltimeMilliseconds);
+}
+
+QList<uint> tst_bench_QNotifications::sendAndWait(int count)
+{
+    QList<QNotificationRequest> requests;
+    requests.reserve(count);
+    for (int i = 0; i < count; ++i)
+        requests.append(QNotificationRequest(u"Benchmark"_s, u"Notification %1"_s.arg(i)));
+
+    QFuture<QList<uint>> future = m_notifications->sendNotifications(requests);
+    if (!QTest::qWaitFor([&future] { return future.isFinished(); }, 30000))
+        return {};
+    return future.result();
+}
+
+void tst_bench_QNotifications::sendSync()
+{
+    Samples samples;
+    samples.nanoseconds.reserve(m_iterations);
+    QElapsedTimer total;
+    total.start();
+    for (int i = 0; i < m_iterations; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        const uint id = m_notifications->sendNotification(u"Benchmark"_s, u"Synchronous send"_s);
+        samples.nanoseconds.append(timer.nsecsElapsed());
+        QVERIFY(id != 0);
+    }
+    samples.totalNanoseconds = total.nsecsElapsed();
+    record(u"sendSync"_s, samples);
+}
+
+void tst_bench_QNotifications::sendAsync()
+{
+    Samples samples;
+    samples.nanoseconds.reserve(m_iterations);
+    int failures = 0;
+    QElapsedTimer total;
+    total.start();
+    for (int i = 0; i < m_iterations; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        m_notifications->sendNotificationAsync(u"Benchmark"_s, u"Asynchronous send"_s)
+                .then(this, [&samples, &failures, timer](uint id) {
+                    samples.nanoseconds.append(timer.nsecsElapsed());
+                    if (id == 0)
+                        ++failures;
+                });
+    }
+    QVERIFY(QTest::qWaitFor([&] { return samples.nanoseconds.size() == m_iterations; }, 30000));
+    samples.totalNanoseconds = total.nsecsElapsed();
+    QCOMPARE(failures, 0);
+    record(u"sendAsync"_s, samples);
+}
+
+void tst_bench_QNotifications::sendBatch()
+{
+    QElapsedTimer total;
+    total.start();
+    const QList<uint> ids = sendAndWait(m_iterations);
+    Samples samples;
+    samples.totalNanoseconds = total.nsecsElapsed();
+    QCOMPARE(ids.size(), m_iterations);
+    QVERIFY(!ids.contains(0u));
+
+    // Every notification of a batch completes together with the batch
+    samples.nanoseconds.fill(samples.totalNanoseconds, ids.size());
+    record(u"sendBatch"_s, samples);
+}
+
+template <typename Emit, typename Signal>
+void tst_bench_QNotifications::measureDispatch(const QString &name, Signal signal, Emit emitEvents)
+{
+    const QList<uint> ids = sendAndWait(m_iterations);
+    QCOMPARE(ids.size(), m_iterations);
+
+    int received = 0;
+    QMetaObject::Connection connection = connect(m_notifications, signal, this, [&received] { ++received; });
+    QElapsedTimer timer;
+    timer.start();
+    QMetaObject::invokeMethod(m_server, [this, ids, emitEvents] { emitEvents(m_server, ids); });
+    const bool allReceived = QTest::qWaitFor([&] { return received >= ids.size(); }, 30000);
+    const qint64 elapsed = timer.nsecsElapsed();
+    disconnect(connection);
+    QVERIFY2(allReceived, qPrintable(u"received %1 of %2 signals"_s.arg(received).arg(ids.size())));
+    recordDispatch(name, received, elapsed);
+}
+
+void tst_bench_QNotifications::dispatchActionInvoked()
+{
+    measureDispatch(u"dispatchActionInvoked"_s, &QNotifications::actionInvoked,
+                    [](MockNotificationServer *server, const QList<uint> &ids) {
+                        server->emitActionInvoked(ids, u"open"_s);
+                    });
+}
+
+void tst_bench_QNotifications::dispatchNotificationClosed()
+{
+    measureDispatch(u"dispatchNotificationClosed"_s, &QNotifications::notificationClosed,
+                    [](MockNotificationServer *server, const QList<uint> &ids) {
+                        server->emitNotificationClosed(ids, 2);
+                    });
+}
+
+QTEST_GUILESS_MAIN(tst_bench_QNotifications)
+
+#include "tst_bench_qnotifications.moc"
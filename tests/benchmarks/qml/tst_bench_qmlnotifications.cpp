@@ -0,0 +1,113 @@
+#include <QtTest/QtTest>
+#include <QtQml/QQmlComponent>
+#include <QtQml/QQmlEngine>
+
+#include <memory>
+
+using namespace Qt::StringLiterals;
+
+// Sends from JavaScript through the Notifications QML type to the loopback
+// engine, so that the time measured is the cost of crossing from JavaScript
+// into a notification request rather than that of a notification server.
+class tst_bench_QmlNotifications : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sendNotification_data();
+    void sendNotification();
+
+private:
+    QQmlEngine *m_engine = nullptr;
+    std::unique_ptr<QObject> m_notifications;
+    int m_count = 10000;
+};
+
+void tst_bench_QmlNotifications::initTestCase()
+{
+    // Read when the Notifications object creates its QNotifications
+    qputenv("QT_NOTIFICATIONS_ENGINE", "loopback");
+
+    const int count = qEnvironmentVariableIntValue("QTNOTIFICATIONS_BENCHMARK_ITERATIONS");
+    if (count > 0)
+        m_count = count;
+
+    m_engine = new QQmlEngine(this);
+    QQmlComponent component(m_engine);
+    component.setData(R"(
+        import QtNotifications
+
+        Notifications {
+            function sendPlain(count) {
+                let sent = 0;
+                for (let i = 0; i < count; ++i) {
+                    if (sendNotification("Benchmark", "Notification " + i) !== 0)
+                        ++sent;
+                }
+                return sent;
+            }
+
+            function sendWithParameters(count) {
+                let sent = 0;
+                for (let i = 0; i < count; ++i) {
+                    if (sendNotification("Benchmark", "Notification " + i,
+                                         { "urgency": 1, "category": "benchmark",
+                                           "x-sequence": i }) !== 0)
+                        ++sent;
+                }
+                return sent;
+            }
+
+            function sendWithActions(count) {
+                let sent = 0;
+                for (let i = 0; i < count; ++i) {
+                    if (sendNotification("Benchmark", "Notification " + i,
+                                         { "urgency": 1, "category": "benchmark",
+                                           "x-sequence": i },
+                                         { "open": "Open", "dismiss": "Dismiss" }) !== 0)
+                        ++sent;
+                }
+                return sent;
+            }
+        }
+    )"_ba, QUrl());
+    m_notifications.reset(component.create());
+    QVERIFY2(m_notifications, qPrintable(component.errorString()));
+
+    bool supported = false;
+    QVERIFY(QMetaObject::invokeMethod(m_notifications.get(), "isSupported", Q_RETURN_ARG(bool, supported)));
+    QVERIFY(supported);
+}
+
+void tst_bench_QmlNotifications::cleanupTestCase()
+{
+    m_notifications.reset();
+}
+
+void tst_bench_QmlNotifications::sendNotification_data()
+{
+    QTest::addColumn<QByteArray>("function");
+
+    QTest::newRow("plain") << "sendPlain"_ba;
+    QTest::newRow("parameters") << "sendWithParameters"_ba;
+    QTest::newRow("parameters and actions") << "sendWithActions"_ba;
+}
+
+void tst_bench_QmlNotifications::sendNotification()
+{
+    QFETCH(QByteArray, function);
+
+    QVariant sent;
+    QBENCHMARK {
+        QVERIFY(QMetaObject::invokeMethod(m_notifications.get(), function.constData(),
+                                          Q_RETURN_ARG(QVariant, sent), Q_ARG(QVariant, m_count)));
+    }
+    QCOMPARE(sent.toInt(), m_count);
+}
+
+QTEST_GUILESS_MAIN(tst_bench_QmlNotifications)
+
+#include "tst_bench_qmlnotifications.moc"
@@ -0,0 +1,327 @@
+#ifndef MOCKNOTIFICATIONSERVER_H
+#define MOCKNOTIFICATIONSERVER_H
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+#include <QtDBus/QDBusArgument>
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusContext>
+#include <QtDBus/QDBusMessage>
+
+#include <utility>
+
+using namespace Qt::StringLiterals;
+
+// Scriptable stand-in for a desktop notification daemon. It lives on its own
+// thread, so blocking calls made by the engine on the main thread get served.
+class MockNotificationServer : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.Notifications")
+
+public:
+    bool start(const QString &address)
+    {
+        QDBusConnection connection = QDBusConnection::connectToBus(address, connectionName());
+        return connection.isConnected()
+            && connection.registerObject(u"/org/freedesktop/Notifications"_s, this,
+                                         QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals)
+            && connection.registerService(u"org.freedesktop.Notifications"_s);
+    }
+
+    void stop()
+    {
+        QDBusConnection::disconnectFromBus(connectionName());
+    }
+
+    void setReplyDelay(int milliseconds) { m_replyDelay.storeRelaxed(milliseconds); }
+    void setRejecting(bool rejecting) { m_rejecting.storeRelaxed(rejecting); }
+    // Shows updates as new notifications, as for notifications that are gone
+    void setRenumbering(bool renumbering) { m_renumbering.storeRelaxed(renumbering); }
+    // Expires every notification right after the reply that announces its ID
+    void setExpiringOnNotify(bool expiring) { m_expiringOnNotify.storeRelaxed(expiring); }
+
+    // While held, Notify calls are answered only once releaseReplies() is
+    // called, so that the calls the engine writes without waiting can be counted
+    void setRepliesHeld(bool held) { m_repliesHeld.storeRelaxed(held); }
+
+    qsizetype heldReplyCount() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_heldReplies.size();
+    }
+
+    void releaseReplies()
+    {
+        QList<HeldReply> replies;
+        {
+            QMutexLocker locker(&m_mutex);
+            replies = std::exchange(m_heldReplies, {});
+        }
+        for (const HeldReply &reply : std::as_const(replies))
+            reply.connection.send(reply.call.createReply(reply.id));
+    }
+
+    // The arguments of the last Notify call, in the order of the specification
+    QVariantList lastArguments() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_lastArguments;
+    }
+
+    QString lastBody() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_lastBody;
+    }
+
+    QVariantMap lastHints() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_lastHints;
+    }
+
+    // The image-data hint of the last Notify call, as the (iiibiiay) structure
+    // of the specification
+    struct ImageData
+    {
+        int width = 0;
+        int height = 0;
+        int rowStride = 0;
+        bool hasAlpha = false;
+        int bitsPerSample = 0;
+        int channels = 0;
+        QByteArray data;
+    };
+
+    ImageData lastImageData() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_lastImageData;
+    }
+
+    // The replaces_id of every update received, in order
+    QList<uint> replacedIds() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_replacedIds;
+    }
+
+    int serverInformationCount() const { return m_serverInformationCount.loadRelaxed(); }
+
+    // The ID of every CloseNotification call received, in order
+    QList<uint> closedIds() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_closedIds;
+    }
+
+    void emitActionInvoked(const QList<uint> &ids, const QString &actionKey)
+    {
+        for (uint id : ids)
+            emit ActionInvoked(id, actionKey);
+    }
+
+    void emitNotificationClosed(const QList<uint> &ids, uint reason)
+    {
+        for (uint id : ids)
+            emit NotificationClosed(id, reason);
+    }
+
+public Q_SLOTS:
+    uint Notify(const QString &appName, uint replacesId, const QString &appIcon,
+                const QString &summary, const QString &body, const QStringList &actions,
+                const QVariantMap &hints, int expireTimeout)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_lastArguments = { appName, replacesId, appIcon, summary, body, actions, hints, expireTimeout };
+            m_lastBody = body;
+            m_lastHints = hints;
+            m_lastImageData = ImageData();
+            if (const QVariant image = hints.value(u"image-data"_s); image.canConvert<QDBusArgument>()) {
+                const QDBusArgument argument = image.value<QDBusArgument>();
+                argument.beginStructure();
+                argument >> m_lastImageData.width >> m_lastImageData.height >> m_lastImageData.rowStride
+                         >> m_lastImageData.hasAlpha >> m_lastImageData.bitsPerSample
+                         >> m_lastImageData.channels >> m_lastImageData.data;
+                argument.endStructure();
+            }
+            if (replacesId != 0)
+                m_replacedIds.append(replacesId);
+        }
+        if (const int delay = m_replyDelay.loadRelaxed(); delay > 0)
+            QThread::msleep(delay);
+        if (m_rejecting.loadRelaxed()) {
+            sendErrorReply(QDBusError::InvalidArgs, u"Rejected by the mock server"_s);
+            return 0;
+        }
+        const uint id = replacesId && !m_renumbering.loadRelaxed() ? replacesId : ++m_lastId;
+        if (m_repliesHeld.loadRelaxed() && message().isReplyRequired()) {
+            setDelayedReply(true);
+            QMutexLocker locker(&m_mutex);
+            m_heldReplies.append({ connection(), message(), id });
+            return 0;
+        }
+        // Queued, so that the signal follows the reply on the bus
+        if (m_expiringOnNotify.loadRelaxed())
+            QMetaObject::invokeMethod(this, [this, id] { emit NotificationClosed(id, 1); }, Qt::QueuedConnection);
+        return id;
+    }
+
+    void CloseNotification(uint id)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_closedIds.append(id);
+        }
+        emit NotificationClosed(id, 3);
+    }
+
+    // Without body-markup, so that the engine sends bodies as plain text
+    QStringList GetCapabilities()
+    {
+        return { u"actions"_s, u"body"_s, u"icon-static"_s };
+    }
+
+    QString GetServerInformation(QString &vendor, QString &version, QString &specVersion)
+    {
+        m_serverInformationCount.fetchAndAddRelaxed(1);
+        vendor = u"The Qt Company"_s;
+        version = QString::fromLatin1(qVersion());
+        specVersion = u"1.2"_s;
+        return u"qtnotifications-mock"_s;
+    }
+
+Q_SIGNALS:
+    void ActionInvoked(uint id, const QString &actionKey);
+    void NotificationClosed(uint id, uint reason);
+
+private:
+    static QString connectionName() { return u"qtnotifications-mock"_s; }
+
+    struct HeldReply
+    {
+        QDBusConnection connection;
+        QDBusMessage call;
+        uint id;
+    };
+
+    QAtomicInteger<int> m_replyDelay;
+    QAtomicInteger<bool> m_rejecting;
+    QAtomicInteger<bool> m_renumbering;
+    QAtomicInteger<bool> m_expiringOnNotify;
+    QAtomicInteger<bool> m_repliesHeld;
+    QAtomicInteger<int> m_serverInformationCount;
+    mutable QMutex m_mutex;
+    QVariantList m_lastArguments;
+    QString m_lastBody;
+    QVariantMap m_lastHints;
+    ImageData m_lastImageData;
+    QList<uint> m_replacedIds;
+    QList<uint> m_closedIds;
+    QList<HeldReply> m_heldReplies;
+    uint m_lastId = 0;
+};
+
+// A private dbus-daemon with a MockNotificationServer on it. Once started,
+// the session bus of the process is the private bus; the engine connects to
+// the session bus lazily, so it is redirected as long as no notification was
+// sent before.
+class MockNotificationBus
+{
+public:
+    enum Status {
+        Started,
+        DaemonUnavailable,
+        Failed
+    };
+
+    ~MockNotificationBus() { stop(); }
+
+    Status start()
+    {
+        if (!m_runtimeDir.isValid())
+            return Failed;
+        const QString configPath = m_runtimeDir.filePath(u"session.conf"_s);
+        QFile config(configPath);
+        if (!config.open(QIODevice::WriteOnly | QIODevice::Text))
+            return Failed;
+        config.write("<!DOCTYPE busconfig PUBLIC \"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\"\n"
+                     " \"http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd\">\n"
+                     "<busconfig>\n"
+                     "  <type>session</type>\n"
+                     "  <listen>unix:dir=" + m_runtimeDir.path().toUtf8() + "</listen>\n"
+                     "  <policy context=\"default\">\n"
+                     "    <allow send_destination=\"*\" eavesdrop=\"true\"/>\n"
+                     "    <allow eavesdrop=\"true\"/>\n"
+                     "    <allow own=\"*\"/>\n"
+                     "  </policy>\n"
+                     "</busconfig>\n");
+        config.close();
+
+        m_daemon.setProgram(u"dbus-daemon"_s);
+        m_daemon.setArguments({ u"--config-file="_s + configPath, u"--nofork"_s, u"--print-address"_s });
+        m_daemon.start();
+        if (!m_daemon.waitForStarted())
+            return DaemonUnavailable;
+        if (!m_daemon.waitForReadyRead(5000))
+            return Failed;
+        m_address = QString::fromUtf8(m_daemon.readLine()).trimmed();
+        if (m_address.isEmpty())
+            return Failed;
+        qputenv("DBUS_SESSION_BUS_ADDRESS", m_address.toUtf8());
+
+        m_server = new MockNotificationServer;
+        m_server->moveToThread(&m_serverThread);
+        QObject::connect(&m_serverThread, &QThread::finished, m_server, &QObject::deleteLater);
+        m_serverThread.start();
+        bool registered = false;
+        QMetaObject::invokeMethod(m_server, [this, &registered] {
+            registered = m_server->start(m_address);
+        }, Qt::BlockingQueuedConnection);
+        return registered ? Started : Failed;
+    }
+
+    void stop()
+    {
+        if (m_server) {
+            QMetaObject::invokeMethod(m_server, [this] { m_server->stop(); }, Qt::BlockingQueuedConnection);
+            m_serverThread.quit();
+            m_serverThread.wait();
+            m_server = nullptr;
+        }
+        if (m_daemon.state() != QProcess::NotRunning) {
+            m_daemon.terminate();
+            m_daemon.waitForFinished();
+        }
+    }
+
+    // Replaces the server by one with another unique name, as when the
+    // notification daemon of the session restarts
+    bool restartServer()
+    {
+        bool registered = false;
+        QMetaObject::invokeMethod(m_server, [this, &registered] {
+            m_server->stop();
+            registered = m_server->start(m_address);
+        }, Qt::BlockingQueuedConnection);
+        return registered;
+    }
+
+    QString address() const { return m_address; }
+    MockNotificationServer *server() const { return m_server; }
+
+private:
+    QTemporaryDir m_runtimeDir;
+    QProcess m_daemon;
+    QString m_address;
+    QThread m_serverThread;
+    MockNotificationServer *m_server = nullptr;
+};
+
+#endif // MOCKNOTIFICATIONSERVER_H